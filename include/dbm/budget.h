@@ -0,0 +1,109 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : budget.h
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_DBM_BUDGET_H
+#define INCLUDE_DBM_BUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+/**
+ * @file The type budget_t bounds the anytime reductions of fed_t
+ * (expensiveReduce, mergeReduce and expensiveConvexReduce with a
+ * budget) by a deadline and/or a number of work steps, and can be
+ * cancelled from another thread. A step is roughly the comparison of
+ * two DBMs. When the budget runs out the reduction stops and leaves a
+ * valid federation, reduced only partially:
+ *
+ *   budget_t budget(0.01);  // 10ms
+ *   fed.expensiveReduce(budget);
+ *   if (budget.wasInterrupted()) ...
+ *
+ * Once exhausted or cancelled, a budget stays so.
+ */
+
+namespace dbm
+{
+    class budget_t
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /// Unlimited budget, that can only be cancelled.
+        budget_t() = default;
+
+        /// Budget of seconds from now and of steps, 0 for no limit.
+        explicit budget_t(double seconds, size_t steps = 0): maxWork(steps)
+        {
+            if (seconds > 0) {
+                setDeadline(clock::now() + std::chrono::duration_cast<clock::duration>(
+                                               std::chrono::duration<double>(seconds)));
+            }
+        }
+
+        budget_t(const budget_t&) = delete;
+        budget_t& operator=(const budget_t&) = delete;
+
+        void setDeadline(clock::time_point time)
+        {
+            deadline = time;
+            hasDeadline = true;
+        }
+
+        /// @param max steps, 0 for no limit.
+        void setMaxWork(size_t max) { maxWork = max; }
+
+        /// Stop the reductions using this budget at their next step.
+        /// May be called from any thread.
+        void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+        bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+        /// Account for steps of work.
+        /// @return true if the work may continue, false if the
+        /// budget is exhausted or cancelled.
+        bool spend(size_t steps = 1)
+        {
+            if (interrupted) {
+                return false;
+            }
+            work += steps;
+            if (isCancelled() || (maxWork != 0 && work > maxWork)) {
+                interrupted = true;
+            } else if (hasDeadline && work >= nextCheck) {
+                nextCheck = work + CHECK_STEPS;  // reading the clock is not free
+                interrupted = clock::now() >= deadline;
+            }
+            return !interrupted;
+        }
+
+        /// @return the number of steps done so far.
+        size_t getWork() const { return work; }
+
+        /// @return true if a reduction stopped before the end
+        /// because of this budget.
+        bool wasInterrupted() const { return interrupted; }
+
+    private:
+        static constexpr size_t CHECK_STEPS = 16;
+
+        std::atomic<bool> cancelled{false};
+        bool interrupted = false;
+        bool hasDeadline = false;
+        clock::time_point deadline;
+        size_t maxWork = 0;
+        size_t work = 0;
+        size_t nextCheck = 0;
+    };
+}  // namespace dbm
+
+#endif  // INCLUDE_DBM_BUDGET_H
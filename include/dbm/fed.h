@@ -37,10 +37,12 @@ namespace dbm
     class ifed_t;
     class fdbm_t;
     class dbmlist_t;
+    class FedIndex;
 
     // public classes
     class dbm_t;
     class fed_t;
+    class budget_t;
 
     /// Wrapper class for clock operations, @see dbm_t
     template <class TYPE>
@@ -316,6 +318,21 @@ namespace dbm
         const uint32_t* getMinDBM(size_t* size) const;
 #endif
 
+        /** @return the upper bounds of the clocks, i.e., column 0 of
+         * the DBM as a raw_t[dim]. The result is cached like getMinDBM
+         * and computed when the DBM is interned.
+         * @pre !isEmpty()
+         */
+        const raw_t* getUpperBounds() const;
+
+        /** Quick reject in O(dim) before O(dim^2) tests.
+         * @return true if the bounds of the clocks show that this DBM
+         * and arg do not intersect, false if they may intersect.
+         * @pre same dimension, !isEmpty() and !arg.isEmpty().
+         */
+        bool hasDisjointBounds(const dbm_t& arg) const;
+        bool hasDisjointBounds(const raw_t* arg, cindex_t dim) const;
+
         /** Relation with a mingraph_t, @see dbm_relationWithMinDBM.
          * @pre unpackBuffer is a raw_t[dim*dim].
          */
@@ -803,6 +820,19 @@ namespace dbm
         /// Copy a DBM matrix in a federation.
         fed_t(const raw_t* arg, cindex_t dim);
 
+        /// Copy count DBM matrices stored one after the other in a
+        /// federation, in the same order, with their memory allocated
+        /// at once. This is much cheaper than count calls to add.
+        /// @param unique: skip the DBMs equal to another one.
+        /// @param reduce: reduce() the result.
+        /// @pre the DBMs are closed and not empty.
+        fed_t(const raw_t* dbms, size_t count, cindex_t dim, bool unique = false, bool reduce = false);
+
+        /// Federation of count DBMs, in the same order, shared and not
+        /// copied. Empty DBMs are skipped.
+        /// @pre the non empty DBMs have the dimension dim.
+        fed_t(const dbm_t* dbms, size_t count, cindex_t dim, bool unique = false, bool reduce = false);
+
         ~fed_t();
 
         /// @return the number of DBMs in this federation.
@@ -858,6 +888,10 @@ namespace dbm
         bool sameAs(const fed_t& arg) const;
 
         /// Try to share the DBMs. Side-effect: affects all copies of this fed_t.
+        /// The federation itself is shared with the interned federations
+        /// that have the same DBMs (in any order), so that sameAs, and
+        /// thus relation and eq, is immediate for equal interned
+        /// federations. A federation stays interned until it is modified.
         void intern();
 
         /// Overload of standard operators.
@@ -955,7 +989,9 @@ namespace dbm
         fed_t& driftWiden();
 
         /// (Set) union operator (|). Inclusion is checked and the
-        /// operation has the effect of reduce() on the argument.
+        /// operation has the effect of reduce() on the argument:
+        /// whatever the sizes, the DBMs of arg included in DBMs of
+        /// this federation or in other DBMs of arg are not added.
         /// @pre same dimension.
 
         fed_t& operator|=(const fed_t&);
@@ -1016,6 +1052,96 @@ namespace dbm
         fed_t& operator-=(const dbm_t&);
         fed_t& operator-=(const raw_t*);
 
+        /// Subtraction as -= but the resulting DBMs may overlap if
+        /// disjoint is false: the pieces are not tightened by the
+        /// previous splits, which is cheaper and gives larger DBMs.
+        /// That is enough for emptiness or inclusion checks. Beware
+        /// that overlapping pieces are split again by every DBM of
+        /// a federation arg, so the result may grow much faster.
+        /// @pre same dimension, dbm_isValid(arg, dim).
+        fed_t& subtract(const fed_t& arg, bool disjoint);
+        fed_t& subtract(const dbm_t& arg, bool disjoint);
+        fed_t& subtract(const raw_t* arg, cindex_t dim, bool disjoint);
+
+        /// Subtract a DBM from the DBMs of a federation in parallel
+        /// when the federation has at least minSize DBMs. The result
+        /// is the same as the sequential subtraction, in the same order.
+        /// Subtractions are sequential by default.
+        /// @param nbThreads: number of threads, including the caller,
+        /// <= 1 to subtract sequentially.
+        /// @param minSize: minimal number of DBMs of the federation.
+        /// @pre no subtraction is running.
+        static void parallelSubtraction(size_t nbThreads, size_t minSize = 64);
+
+        /// Apply up, down, freeClock, updateValue, constrain, the
+        /// relax and the extrapolation functions to the DBMs of a
+        /// federation in parallel when the federation has at least
+        /// minSize DBMs. The result is the same as the sequential
+        /// loop, in the same order. As sequentially, up, down, freeClock,
+        /// updateValue and constrain leave the DBMs they do not change
+        /// untouched; the relax and extrapolation functions copy every DBM.
+        /// They are sequential by default.
+        /// @param nbThreads: number of threads, including the caller,
+        /// <= 1 to run them sequentially.
+        /// @param minSize: minimal number of DBMs of the federation.
+        /// @pre none of these operations is running.
+        static void parallelOperations(size_t nbThreads, size_t minSize = 256);
+
+        /// Order in which a subtraction splits a DBM along the
+        /// constraints of the minimal graph of the subtracted DBM.
+        /// The order changes the number of resulting DBMs.
+        enum subtraction_t {
+            SUBTRACT_MINGRAPH,  //< no reordering, cheapest
+            SUBTRACT_TIGHTEST,  //< most tightening constraints first
+            SUBTRACT_WORST,     //< constraints with facets outside first (default)
+            SUBTRACT_ADAPTIVE   //< choose per subtracted DBM from the statistics
+        };
+
+        /// What a strategy gave, summed over all subtractions of one
+        /// DBM from another.
+        struct subtraction_stats_t
+        {
+            size_t calls;   //< subtractions
+            size_t splits;  //< constraints split on
+            size_t pieces;  //< resulting DBMs
+        };
+
+        /// Set the strategy of the subtractions. The adaptive strategy
+        /// learns which of the others gives the fewest DBMs depending on
+        /// the dimension and the size of the minimal graph of the
+        /// subtracted DBM, using the statistics below. It chooses once
+        /// per subtracted DBM, so the DBMs of a federation are split
+        /// the same way whether they are subtracted in parallel or not.
+        static void subtractionStrategy(subtraction_t strategy);
+
+        /// @return the statistics of a strategy, != SUBTRACT_ADAPTIVE.
+        static subtraction_stats_t getSubtractionStats(subtraction_t strategy);
+
+        /// Reset the statistics, and what the adaptive strategy learnt.
+        static void resetSubtractionStats();
+
+        /// Index the DBMs of federations that have at least minSize
+        /// DBMs by the bounds of their clocks so that intersects,
+        /// contains, has, relations with DBMs and intersections with
+        /// federations only look at the DBMs that may match. The index
+        /// is built on the first such query and dropped when the
+        /// federation is modified. Federations are not indexed by default.
+        /// @param minSize: minimal number of DBMs, 0 to disable.
+        /// @pre no federation is being modified through an iterator.
+        static void spatialIndex(size_t minSize);
+
+        /// Remember the results of the last nbEntries calls of predt
+        /// with a federation of bad DBMs and of succt, for fixpoint
+        /// computations that call them again with the same arguments.
+        /// Arguments are the same if they have the same DBMs in the
+        /// same order. They are looked up by the hash values of the
+        /// federations, which interned federations keep (see intern()),
+        /// and their DBMs are compared only when the hash values match.
+        /// isIncludedInPredt uses the remembered predt if there is one.
+        /// Nothing is remembered by default.
+        /// @param nbEntries: number of results, 0 to forget all.
+        static void predtCache(size_t nbEntries);
+
         /// Compute (*this -= arg).down(). The interest of this
         /// call is that some subtractions can be avoided if the
         /// following down() negates their effects.
@@ -1128,6 +1254,11 @@ namespace dbm
         fed_t& relaxAll();
 
         /// Remove redundant DBMs (if included in ONE other DBM).
+        /// The reductions are incremental: after reduce, mergeReduce or
+        /// expensiveReduce, the DBMs appended with appendEnd or steal are
+        /// compared with all the others by the next reduction of the same
+        /// kind, but the DBMs already reduced are not compared again.
+        /// Any other modification makes the next reduction complete.
         /// @post side effect: all copies of this fed_t are affected so
         /// do not mix iterators and reduce().
         /// @return this.
@@ -1171,6 +1302,20 @@ namespace dbm
         /// @return this.
         fed_t& partitionReduce();
 
+        /// Anytime variants of the reductions above: they stop when
+        /// the budget is exhausted or cancelled and leave a valid
+        /// federation, partially reduced by mergeReduce and
+        /// expensiveReduce. expensiveConvexReduce leaves it unchanged
+        /// if the budget runs out during the subtractions, and
+        /// otherwise replaces it if the partially merged result is
+        /// smaller.
+        /// The budget tells how much work was done and whether
+        /// the reduction was interrupted, @see budget.h.
+        /// @return this.
+        fed_t& expensiveReduce(budget_t& budget);
+        fed_t& mergeReduce(budget_t& budget, size_t skip = 0, int level = 0);
+        fed_t& expensiveConvexReduce(budget_t& budget);
+
         /// @return true if a point (discrete or "real") is included
         /// in this federation (ie in one of its DBMs).
         /// @pre same dimension.
@@ -1583,12 +1728,12 @@ namespace dbm
 
         /// Internal subtraction implemention (*this - arg).
         /// @pre !isEmpty() && isMutable()
-        void ptr_subtract(const raw_t* arg, cindex_t dim);
+        void ptr_subtract(const raw_t* arg, cindex_t dim, bool disjoint);
 
 #ifdef ENABLE_STORE_MINGRAPH
         /// Internal subtraction implemention (*this - arg).
         /// @pre !isEmpty() && isMutable() && !arg.isEmpty()
-        void ptr_subtract(const dbm_t& arg);
+        void ptr_subtract(const dbm_t& arg, bool disjoint);
 #endif
 
         /// Similarly with a DBM. @pre isPointer()
@@ -1597,6 +1742,10 @@ namespace dbm
         /// @return true if this DBM can be ignored in subtractDown.
         bool canSkipSubtract(const raw_t*, cindex_t) const;
 
+        /// Reductions with an optional budget.
+        fed_t& expensiveReduce(budget_t* budget);
+        fed_t& expensiveConvexReduce(budget_t* budget);
+
         ifed_t* ifedPtr;
     };
 
@@ -25,6 +25,9 @@
 #include "hash/tables.h"
 #include "debug/macros.h"
 
+#include <algorithm>
+#include <array>
+
 /** @file
  * This file contains internal classes and inlined implementation of fed.h.
  */
@@ -79,6 +82,9 @@ namespace dbm
 
     static inline void* dbm_new(cindex_t dim);
 
+    /// Nothing to reserve with new.
+    inline void dbm_reserve(cindex_t, size_t) {}
+
 #else  // ifndef ENABLE_DBM_NEW
 
     /** Allocate memory with a local allocator.
@@ -96,6 +102,11 @@ namespace dbm
      */
     void dbm_delete(idbm_t* dbm);
 
+    /** Prepare n allocations of idbm_t of dimension dim
+     * at once, before building a large federation.
+     */
+    void dbm_reserve(cindex_t dim, size_t n);
+
 #endif  // ENABLE_DBM_NEW
 
     /**************************************************
@@ -142,6 +153,26 @@ namespace dbm
         void copyMinGraphTo(idbm_t* arg);
 #endif
 
+        /// Invalidate its upper bounds.
+        void invalidateBounds() { upperBounds()[0] = dbm_LS_INFINITY; }
+
+        /// Test if the upper bounds are valid.
+        bool areBoundsValid() const { return upperBounds()[0] == dbm_LE_ZERO; }
+
+        /// @return its upper bounds, i.e., column 0 of the DBM stored
+        /// contiguously after the matrix, recomputed if needed.
+        const raw_t* getUpperBounds()
+        {
+            raw_t* upper = upperBounds();
+            if (upper[0] != dbm_LE_ZERO) {
+                cindex_t dim = getDimension();
+                for (cindex_t i = 0; i < dim; ++i) {
+                    upper[i] = matrix[i * dim];
+                }
+            }
+            return upper;
+        }
+
         /// @return true if this dbm can be modified.
         bool isMutable() const
         {
@@ -158,6 +189,7 @@ namespace dbm
 #ifdef ENABLE_STORE_MINGRAPH
             invalidate();  // We're going to change this DBM.
 #endif
+            invalidateBounds();
             if (isHashed())
                 unhash();
             return true;
@@ -269,6 +301,7 @@ namespace dbm
 #ifdef ENABLE_STORE_MINGRAPH
             invalidate();
 #endif
+            invalidateBounds();
         }
 
         /** Constructor by copy: useful to get a mutable copy
@@ -281,12 +314,26 @@ namespace dbm
 #ifdef ENABLE_STORE_MINGRAPH
             invalidate();
 #endif
+            invalidateBounds();
             dbm_copy(matrix, other.matrix, info);
         }
 
     private:
         ~idbm_t() = delete;  ///< Must never be called
 
+        /// @return where the upper bounds are stored.
+        raw_t* upperBounds() { return const_cast<raw_t*>(static_cast<const idbm_t*>(this)->upperBounds()); }
+        const raw_t* upperBounds() const
+        {
+            size_t dim2 = getDimension();
+            dim2 *= dim2;
+#ifdef ENABLE_STORE_MINGRAPH
+            return &matrix[dim2 + bits2intsize(dim2)];
+#else
+            return &matrix[dim2];
+#endif
+        }
+
         /* Inherited variables from parent class:
          * idbm_t **previous, *next: for collision list of
          * the internal hash table.
@@ -309,9 +356,9 @@ namespace dbm
     static inline void* dbm_new(cindex_t dim)
     {
 #ifdef ENABLE_STORE_MINGRAPH
-        return new int32_t[sizeof(idbm_t) + dim * dim + bits2intsize(dim * dim)];
+        return new int32_t[sizeof(idbm_t) + dim * dim + bits2intsize(dim * dim) + dim];
 #else
-        return new int32_t[sizeof(idbm_t) + dim * dim];
+        return new int32_t[sizeof(idbm_t) + dim * dim + dim];
 #endif
     }
 #endif  // ifdef ENABLE_DBM_NEW
@@ -336,6 +383,10 @@ namespace dbm
         fdbm_t* fhead;
         uint32_t refCounter;
         cindex_t dim;
+        void* index;
+        uint32_t internHash;
+        bool interned;
+        uint32_t reduced[4];
     };
 
     /// Allocator instance.
@@ -506,6 +557,10 @@ namespace dbm
         /// and DBMs of arg that are included in 'this'.
         void removeIncluded(dbmlist_t& arg);
 
+        /// Same with an index of this list and the hash values of its DBMs.
+        /// @pre dim > 1.
+        void removeIncludedIndexed(dbmlist_t& arg, cindex_t dim);
+
         /// Union of arg with this dbmlist_t, does inclusion checking
         /// @post dbmlist_t arg is invalid.
         dbmlist_t& unionWith(dbmlist_t& arg)
@@ -516,10 +571,16 @@ namespace dbm
         }
 
         /// Simple reduction by inclusion check of DBMs.
-        void reduce(cindex_t dim);
+        /// @param jumpi is the number of first DBMs already reduced.
+        void reduce(cindex_t dim, size_t jumpi = 0);
+
+        /// Same for the whole list with an index of its DBMs.
+        /// @pre dim > 1.
+        void reduceIndexed(cindex_t dim);
 
-        /// Reduction by inclusion check + merge (by pairs) of DBMs.
-        void mergeReduce(cindex_t dim, size_t jumpj = 0, int expensiveTry = 0);
+        /// Reduction by inclusion check + merge (by pairs) of DBMs,
+        /// until budget (if any) is exhausted.
+        void mergeReduce(cindex_t dim, size_t jumpj = 0, int expensiveTry = 0, budget_t* budget = nullptr);
 
         /// @return the federation size.
         size_t size() const
@@ -743,6 +804,76 @@ namespace dbm
             return create(getDimension(), size() + endSize, fdbm_t::copy(fhead, end));
         }
 
+        /** @return the spatial index of the DBMs, built on demand
+         * if there are at least minSize DBMs, or nullptr. Valid
+         * until dropIndex().
+         */
+        const FedIndex* getIndex(size_t minSize) const;
+
+        /// Drop the spatial index, to call before any modification.
+        void dropIndex()
+        {
+            if (index) {
+                deleteIndex();
+            }
+        }
+
+        /// @return true if this ifed_t is in the table of interned
+        /// federations, see fed_t::intern().
+        bool isInterned() const { return interned; }
+
+        /// Leave the table of interned federations, to call before
+        /// any modification.
+        void unintern()
+        {
+            if (interned) {
+                removeInterned();
+            }
+        }
+
+        /// Reductions whose result is tracked: the first DBMs that
+        /// a reduction left reduced with respect to each other
+        /// are not compared again by the next reduction of the same
+        /// kind, only the DBMs appended after them are.
+        enum reduction_t {
+            REDUCED_INCLUSION,  //< reduce(), implied by the others but convex
+            REDUCED_MERGE,      //< mergeReduce()
+            REDUCED_UNION,      //< expensiveReduce()
+            REDUCED_CONVEX,     //< convexReduce()
+            NB_REDUCED
+        };
+        using reduced_t = std::array<uint32_t, NB_REDUCED>;
+
+        /// @return the number of first DBMs reduced by each kind of reduction.
+        const reduced_t& getReduced() const { return reduced; }
+
+        /// Forget the reductions, to call before any modification
+        /// other than appending DBMs at the end.
+        void resetReduced() { reduced.fill(0); }
+
+        /// Restore the reductions saved before appending DBMs at the end.
+        void restoreReduced(const reduced_t& previous) { reduced = previous; }
+
+        /// Record that a reduction of some kind compared the DBMs after
+        /// the first skip ones with all the others. It only removes some of
+        /// the first DBMs so the other reductions are kept up to skip
+        /// DBMs if nothing was removed.
+        /// @param kind the reduction or NB_REDUCED if it was interrupted.
+        /// @param previous what was reduced before the reduction.
+        /// @param before the size before the reduction.
+        void setReduced(reduction_t kind, const reduced_t& previous, size_t skip, size_t before)
+        {
+            for (size_t k = 0; k < NB_REDUCED; ++k) {
+                reduced[k] = fedSize == before ? std::min<uint32_t>(previous[k], skip) : 0;
+            }
+            if (kind != NB_REDUCED) {
+                reduced[kind] = fedSize;
+                if (kind != REDUCED_CONVEX) {
+                    reduced[REDUCED_INCLUSION] = fedSize;
+                }
+            }
+        }
+
         /// Insert a dbm, @pre same dimension & not empty.
         void insert(const dbm_t& adbm)
         {
@@ -799,8 +930,18 @@ namespace dbm
         /// Deallocate this ifed and its list of DBMs.
         void remove();
 
-        uint32_t refCounter;  //< reference counter
-        cindex_t dim;         //< dimension
+        /// Deallocate the spatial index, @pre index != nullptr.
+        void deleteIndex();
+
+        /// Remove from the table of interned federations, @pre interned.
+        void removeInterned();
+
+        uint32_t refCounter;      //< reference counter
+        cindex_t dim;             //< dimension
+        mutable FedIndex* index;  //< spatial index or nullptr
+        uint32_t internHash;      //< hash value if interned
+        bool interned;            //< in the table of interned federations
+        reduced_t reduced;        //< first DBMs reduced, by kind of reduction
     };
 
     /***********************************************************
@@ -989,6 +1130,45 @@ namespace dbm
     }
 #endif
 
+    inline const raw_t* dbm_t::getUpperBounds() const
+    {
+        assert(!isEmpty());
+        return idbmPtr->getUpperBounds();
+    }
+
+    // Same test as dbm_haveIntersection restricted to the
+    // constraints i,0 and 0,i, reading the cached column 0.
+    inline bool dbm_t::hasDisjointBounds(const dbm_t& arg) const
+    {
+        assert(pdim() == arg.pdim());
+        const raw_t* upper1 = getUpperBounds();
+        const raw_t* upper2 = arg.getUpperBounds();
+        const raw_t* lower1 = const_dbm();
+        const raw_t* lower2 = arg.const_dbm();
+        cindex_t dim = pdim();
+        for (cindex_t i = 1; i < dim; ++i) {
+            if ((upper1[i] != dbm_LS_INFINITY && dbm_negRaw(upper1[i]) >= lower2[i]) ||
+                (upper2[i] != dbm_LS_INFINITY && dbm_negRaw(upper2[i]) >= lower1[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline bool dbm_t::hasDisjointBounds(const raw_t* arg, cindex_t dim) const
+    {
+        assert(pdim() == dim && arg);
+        const raw_t* upper = getUpperBounds();
+        const raw_t* lower = const_dbm();
+        for (cindex_t i = 1; i < dim; ++i) {
+            if ((upper[i] != dbm_LS_INFINITY && dbm_negRaw(upper[i]) >= arg[i]) ||
+                (arg[i * dim] != dbm_LS_INFINITY && dbm_negRaw(arg[i * dim]) >= lower[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     inline int32_t* dbm_t::writeToMinDBMWithOffset(bool minimizeGraph, bool tryConstraints16, allocator_t c_alloc,
                                                    size_t offset) const
     {
@@ -1467,6 +1647,7 @@ namespace dbm
 #ifdef ENABLE_STORE_MINGRAPH
         assert(!idbmt()->isValid());
 #endif
+        assert(!idbmt()->areBoundsValid());
         return idbmt()->dbm();
     }
 
@@ -1702,14 +1883,24 @@ namespace dbm
     inline fed_t& fed_t::reduce()
     {
         assert(isOK());
-        ifed()->reduce(getDimension());
+        ifed_t::reduced_t reduced = ifedPtr->getReduced();
+        size_t skip = *std::max_element(reduced.begin(), reduced.begin() + ifed_t::REDUCED_CONVEX);
+        size_t before = size();
+        ifed()->reduce(getDimension(), skip);
+        ifedPtr->setReduced(ifed_t::REDUCED_INCLUSION, reduced, skip, before);
         return *this;
     }
 
     inline fed_t& fed_t::mergeReduce(size_t skip, int expensiveTry)
     {
         assert(isOK());
+        ifed_t::reduced_t reduced = ifedPtr->getReduced();
+        if (expensiveTry == 0) {  // a more expensive try may merge more
+            skip = std::max<size_t>(skip, reduced[ifed_t::REDUCED_MERGE]);
+        }
+        size_t before = size();
         ifed()->mergeReduce(getDimension(), skip, expensiveTry);
+        ifedPtr->setReduced(ifed_t::REDUCED_MERGE, reduced, skip, before);
         return *this;
     }
 
@@ -1894,6 +2085,10 @@ namespace dbm
     inline ifed_t* fed_t::ifed()
     {
         assert(isPointer(ifedPtr));
+        // may be modified, reductions even modify shared ifed_t
+        ifedPtr->dropIndex();
+        ifedPtr->unintern();
+        ifedPtr->resetReduced();
         return ifedPtr;
     }
 
@@ -1929,7 +2124,11 @@ namespace dbm
     {
         if (!isMutable()) {
             decRefImmutable();
-            ifedPtr = ifed()->copy();
+            ifedPtr = static_cast<const fed_t*>(this)->ifed()->copy();
+        } else {
+            ifedPtr->dropIndex();
+            ifedPtr->unintern();
+            ifedPtr->resetReduced();
         }
         assert(isMutable());
     }
@@ -174,6 +174,36 @@ int32_t* dbm_writeToMinDBMWithOffset(const raw_t* dbm, cindex_t dim, bool minimi
 int32_t* dbm_writeAnalyzedDBM(const raw_t* dbm, cindex_t dim, uint32_t* bitMatrix, size_t nbConstraints,
                               bool tryConstraints16, allocator_t c_alloc, size_t offset);
 
+/**
+ * Batch encoding of nbDBMs DBMs into one arena, phase 1:
+ * analyze the DBMs and compute where they will be written.
+ * The encodings are the same as dbm_writeToMinDBMWithOffset
+ * with the same flags, but there is no allocation per DBM.
+ * @param dbms: nbDBMs closed non-empty DBMs of dimension dim,
+ * stored contiguously, i.e., a raw_t[nbDBMs*dim*dim].
+ * @param minimizeGraph,tryConstraints16: as for dbm_writeToMinDBMWithOffset.
+ * @param bitMatrices: scratch for the minimal graphs, a
+ * uint32_t[nbDBMs*bits2intsize(dim*dim)], to give to phase 2
+ * unchanged. It may be NULL if !minimizeGraph.
+ * @param offsets: a size_t[nbDBMs+1] to write the offsets
+ * of the mingraphs in the arena, offsets[nbDBMs] = total size.
+ * @return the total size in int32_t of the arena to allocate.
+ */
+size_t dbm_getSizeOfMinDBMsFor(const raw_t* dbms, size_t nbDBMs, cindex_t dim, bool minimizeGraph,
+                               bool tryConstraints16, uint32_t* bitMatrices, size_t* offsets);
+
+/**
+ * Batch encoding, phase 2: write the mingraphs in the arena.
+ * @param dbms,nbDBMs,dim,minimizeGraph,tryConstraints16,bitMatrices:
+ * the same as for dbm_getSizeOfMinDBMsFor.
+ * @param offsets: as computed by dbm_getSizeOfMinDBMsFor.
+ * @param arena: an int32_t[offsets[nbDBMs]].
+ * @post mingraph k is at arena + offsets[k] and is read
+ * by dbm_readFromMinDBM or dbm_readFromMinDBMs.
+ */
+void dbm_writeToMinDBMs(const raw_t* dbms, size_t nbDBMs, cindex_t dim, bool minimizeGraph, bool tryConstraints16,
+                        uint32_t* bitMatrices, const size_t* offsets, int32_t* arena);
+
 /**
  * Analyze a DBM for its minimal graph representation. Computes the
  * smallest number of constraints needed to represent the same zone as
@@ -249,6 +279,37 @@ void dbm_bitMatrix2indices(const uint32_t* bitMatrix, size_t nbConstraints, uint
  */
 cindex_t dbm_readFromMinDBM(raw_t* dbm, mingraph_t minDBM);
 
+/** Batch decoding of nbDBMs mingraphs of the same dimension.
+ * @param dbms: where to write, a raw_t[nbDBMs*dim*dim].
+ * @param dim: dimension of all the mingraphs.
+ * @param arena,offsets: mingraph k is at arena + offsets[k],
+ * e.g., as written by dbm_writeToMinDBMs.
+ * @param nbDBMs: number of mingraphs to read.
+ * @pre the mingraphs are neither deltas nor dictionary mingraphs.
+ */
+void dbm_readFromMinDBMs(raw_t* dbms, cindex_t dim, const int32_t* arena, const size_t* offsets, size_t nbDBMs);
+
+/** Decoders of dbm_readFromMinDBM and dbm_readFromMinDBMs. They
+ * all give the same DBMs.
+ */
+typedef enum {
+    dbm_DECODE_REFERENCE, /**< constraint by constraint                 */
+    dbm_DECODE_PORTABLE,  /**< unpack indices and constraints in blocks */
+    dbm_DECODE_NATIVE     /**< same with BMI2 and AVX2 (x86-64)         */
+} decoderOfMinDBM_t;
+
+/** Select the decoder of the mingraphs, for all threads. The
+ * default is dbm_DECODE_NATIVE if the CPU supports it and
+ * dbm_DECODE_PORTABLE otherwise.
+ * @return false if the decoder is not supported here, and
+ * then the decoder is unchanged.
+ */
+bool dbm_setMinDBMDecoder(decoderOfMinDBM_t decoder);
+
+/** @return the current decoder of the mingraphs.
+ */
+decoderOfMinDBM_t dbm_getMinDBMDecoder(void);
+
 /** Dimension of a DBM from its packed minimal representation.
  * @param minDBM: the minimal DBM data directly, without offset.
  * @return dimension of DBM.
@@ -320,6 +381,8 @@ bool dbm_isAnalyzedDBMEqualToMinDBM(const raw_t* dbm, cindex_t dim, uint32_t* bi
  * @pre
  * - dbm is a raw_t[dim*dim] and dim > 0 (at leat ref clock)
  * - buffer != NULL is a raw_t[dim*dim]
+ * - minDBM is neither a delta (see dbm_isDeltaMinDBM) nor a
+ *   dictionary mingraph (see dbm_isDictMinDBM).
  * @post
  * - buffer may be written or not. If you want to know
  *   it, you can set buffer[0] = 0, and test afterwards
@@ -401,9 +464,287 @@ relation_t dbm_approxRelationWithMinDBM(const raw_t* dbm, cindex_t dim, mingraph
  * - dbm is a raw_t[dim*dim] and dim > 0 (at least ref clock).
  * - DBMs have the same dimensions
  * - unpackBuffer != NULL and is a raw_t[dim*dim]
+ * - minDBM is neither a delta (see dbm_isDeltaMinDBM) nor a
+ *   dictionary mingraph (see dbm_isDictMinDBM).
  */
 void dbm_convexUnionWithMinDBM(raw_t* dbm, cindex_t dim, mingraph_t minDBM, raw_t* unpackBuffer);
 
+/*************************************************************************
+ * Delta encoding: successor zones typically differ from their
+ * predecessors in a few constraints only. A delta mingraph stores
+ * only the constraints of a closed DBM that differ from a closed
+ * base DBM, and it is resolved against that base when it is read.
+ * The base is not referenced by the delta: it is the responsibility
+ * of the caller (typically a passed list) to keep the base DBM of its
+ * deltas, e.g., the first zone stored per discrete state, unpacked.
+ *************************************************************************/
+
+/** Save a DBM as a delta against a base DBM.
+ * Same allocation scheme as dbm_writeToMinDBMWithOffset.
+ * @param dbm: the DBM to save.
+ * @param baseDBM: the base DBM to compute the delta against.
+ * @param dim: dimension of both DBMs.
+ * @param tryConstraints16: flag to try to save
+ * constraints on 16 bits.
+ * @param c_alloc: C allocator wrapper
+ * @param offset: offset for allocation.
+ * @return allocated memory.
+ * @pre
+ * - dbm and baseDBM are raw_t[dim*dim], closed and non empty.
+ * - dim > 0 (at least ref clock)
+ * @post the returned memory is of size offset+dbm_getSizeOfMinDBM(delta)
+ * where delta = the returned memory + offset.
+ */
+int32_t* dbm_writeToDeltaMinDBMWithOffset(const raw_t* dbm, const raw_t* baseDBM, cindex_t dim,
+                                          bool tryConstraints16, allocator_t c_alloc, size_t offset);
+
+/** Size (without offset) of the delta that
+ * dbm_writeToDeltaMinDBMWithOffset would write, in int32_t.
+ * This costs dim*dim and allocates nothing.
+ * @param dbm,baseDBM,dim,tryConstraints16: as for
+ * dbm_writeToDeltaMinDBMWithOffset.
+ */
+size_t dbm_getSizeOfDeltaMinDBMFor(const raw_t* dbm, const raw_t* baseDBM, cindex_t dim, bool tryConstraints16);
+
+/** @return true if minDBM is a delta encoding, in which case it must
+ * be read with the delta functions and its base DBM.
+ * @param minDBM: minimal representation (without offset).
+ */
+bool dbm_isDeltaMinDBM(mingraph_t minDBM);
+
+/** Read a DBM from its delta representation.
+ * @param dbm: where to write.
+ * @param baseDBM: the base DBM the delta was computed against.
+ * @param delta: the delta representation (without offset).
+ * @pre dbm and baseDBM are raw_t[dim*dim] where
+ * dim = dbm_getDimOfMinDBM(delta). dbm may be baseDBM
+ * in which case the base is patched in place.
+ * @return dimension of DBM and unpacked DBM in dbm.
+ */
+cindex_t dbm_readFromDeltaMinDBM(raw_t* dbm, const raw_t* baseDBM, mingraph_t delta);
+
+/** Exact relation between a full DBM and a delta representation.
+ * This does not unpack the delta: the constraints are compared
+ * directly against the delta and the base, with early termination
+ * as soon as the DBMs are known to be incomparable.
+ * @param dbm,dim: full DBM of dimension dim.
+ * @param baseDBM: the base DBM the delta was computed against.
+ * @param delta: the delta representation (without offset).
+ * @pre dbm and baseDBM are raw_t[dim*dim], dbm is closed and not empty.
+ * @return base_EQUAL, base_SUBSET, base_SUPERSET or base_DIFFERENT.
+ */
+relation_t dbm_relationWithDeltaMinDBM(const raw_t* dbm, cindex_t dim, const raw_t* baseDBM, mingraph_t delta);
+
+/** Base policy: save a DBM with the cheapest of its minimal
+ * representation and a delta against baseDBM.
+ * The delta is taken when it is not bigger than the constraints
+ * alone of the minimal graph. If baseDBM is NULL, i.e., dbm is the
+ * first zone of its discrete state, then the result is the same as
+ * dbm_writeToMinDBMWithOffset and the caller should keep dbm as the
+ * base of the following zones.
+ * @param dbm,dim: the DBM to save.
+ * @param baseDBM: base DBM or NULL.
+ * @param minimizeGraph,tryConstraints16,c_alloc,offset: as for
+ * dbm_writeToMinDBMWithOffset.
+ * @return allocated memory, read with dbm_readFromMinDBMRelativeTo.
+ */
+int32_t* dbm_writeToMinDBMRelativeTo(const raw_t* dbm, cindex_t dim, const raw_t* baseDBM, bool minimizeGraph,
+                                     bool tryConstraints16, allocator_t c_alloc, size_t offset);
+
+/** Read a DBM written by dbm_writeToMinDBMRelativeTo.
+ * @param dbm: where to write.
+ * @param baseDBM: base DBM, used only if minDBM is a delta.
+ * @param minDBM: minimal or delta representation (without offset).
+ * @return dimension of DBM and unpacked DBM in dbm.
+ */
+cindex_t dbm_readFromMinDBMRelativeTo(raw_t* dbm, const raw_t* baseDBM, mingraph_t minDBM);
+
+/** Relation with a DBM written by dbm_writeToMinDBMRelativeTo.
+ * Deltas always give an exact relation, other representations
+ * follow dbm_relationWithMinDBM.
+ * @param dbm,dim: full DBM of dimension dim.
+ * @param baseDBM: base DBM, used only if minDBM is a delta.
+ * @param minDBM: minimal or delta representation (without offset).
+ * @param unpackBuffer: as for dbm_relationWithMinDBM.
+ */
+relation_t dbm_relationWithMinDBMRelativeTo(const raw_t* dbm, cindex_t dim, const raw_t* baseDBM, mingraph_t minDBM,
+                                            raw_t* unpackBuffer);
+
+/**********************************************
+ * Canonical hash of minimal graphs: the hash
+ * depends only on the constraints of the
+ * minimal graph and not on their encoding,
+ * i.e., 16 or 32 bits, copy or minimal.
+ **********************************************/
+
+/** Canonical hash of an analyzed DBM.
+ * @param dbm,dim: closed DBM of dimension dim.
+ * @param bitMatrix: minimal graph as computed by dbm_analyzeForMinDBM,
+ * cleaned or not by dbm_cleanBitMatrix.
+ * @return the same value as dbm_hashOfMinDBM for any mingraph
+ * written from dbm.
+ */
+uint32_t dbm_hashOfAnalyzedDBM(const raw_t* dbm, cindex_t dim, const uint32_t* bitMatrix);
+
+/** Canonical hash of a mingraph. The minimal formats are hashed
+ * directly on their saved constraints, only the copy formats
+ * are unpacked and analyzed.
+ * @param minDBM: minimal representation (without offset).
+ * @param buffer: a raw_t[dim*dim] where dim = dbm_getDimOfMinDBM(minDBM),
+ * used only for the copy formats.
+ * @return hash value, @see dbm_hashOfAnalyzedDBM.
+ * @pre minDBM is neither a delta (see dbm_isDeltaMinDBM) nor a
+ * dictionary mingraph (see dbm_isDictMinDBM).
+ */
+uint32_t dbm_hashOfMinDBM(mingraph_t minDBM, raw_t* buffer);
+
+/**********************************************
+ * Dictionary encoding: the constraints of the
+ * minimal graphs that occur often in a store
+ * are saved once in a dictionary owned by the
+ * store (see zonestore_t), and the mingraphs
+ * reference them. A mingraph uses references
+ * only when that makes it smaller than its
+ * usual encoding, otherwise it has the usual
+ * encoding. The dictionary only grows: a
+ * constraint seen threshold times is added to
+ * it, so that encoded mingraphs stay valid as
+ * long as the dictionary lives. The functions
+ * without a dictionary treat the mingraphs
+ * that use one as invalid.
+ **********************************************/
+
+/** Opaque type of a dictionary of constraints.
+ */
+typedef struct mingraph_dict_s mingraph_dict_t;
+
+/** Create a dictionary.
+ * @param threshold: number of occurrences of a constraint
+ * before it is added to the dictionary, > 0.
+ * @return a new empty dictionary, to delete with dbm_deleteMinDBMDict.
+ */
+mingraph_dict_t* dbm_newMinDBMDict(uint32_t threshold);
+
+/** Delete a dictionary, the mingraphs that use it are
+ * not readable any more.
+ */
+void dbm_deleteMinDBMDict(mingraph_dict_t* dict);
+
+/** @return the number of constraints in the dictionary.
+ */
+size_t dbm_getNbEntriesOfMinDBMDict(const mingraph_dict_t* dict);
+
+/** Save a DBM with its minimal graph where the constraints
+ * are replaced by references to the dictionary when possible.
+ * The dictionary learns from the saved DBMs.
+ * @param dict: the dictionary of the store.
+ * @param dbm,dim,c_alloc,offset: as for dbm_writeToMinDBMWithOffset.
+ * @return allocated memory, the mingraph is at offset.
+ * @post if the references do not make the mingraph smaller, the
+ * DBM is saved as by dbm_writeToMinDBMWithOffset with minimizeGraph
+ * and tryConstraints16, so the mingraph is never bigger.
+ */
+int32_t* dbm_writeToDictMinDBMWithOffset(mingraph_dict_t* dict, const raw_t* dbm, cindex_t dim,
+                                         allocator_t c_alloc, size_t offset);
+
+/** @return true if minDBM uses a dictionary, in which case it must
+ * be read with the dictionary functions.
+ * @param minDBM: minimal representation (without offset).
+ */
+bool dbm_isDictMinDBM(mingraph_t minDBM);
+
+/** Read a DBM saved by dbm_writeToDictMinDBMWithOffset.
+ * @param dict: the dictionary used to write minDBM.
+ * @param dbm: where to write, a raw_t[dim*dim] with
+ * dim = dbm_getDimOfMinDBM(minDBM).
+ * @param minDBM: minimal representation (without offset).
+ * @return dimension of DBM and unpacked DBM in dbm.
+ */
+cindex_t dbm_readFromDictMinDBM(const mingraph_dict_t* dict, raw_t* dbm, mingraph_t minDBM);
+
+/** Relation with a DBM saved by dbm_writeToDictMinDBMWithOffset,
+ * with the same semantics as dbm_relationWithMinDBM. Without
+ * unpackBuffer the inclusion is tested on the constraints of
+ * the minimal graph directly.
+ * @param dict: the dictionary used to write minDBM.
+ * @param dbm,dim,unpackBuffer: as for dbm_relationWithMinDBM.
+ * @param minDBM: minimal representation (without offset).
+ */
+relation_t dbm_relationWithDictMinDBM(const mingraph_dict_t* dict, const raw_t* dbm, cindex_t dim,
+                                      mingraph_t minDBM, raw_t* unpackBuffer);
+
+/**********************************************
+ * Encoding policies: dbm_writeToMinDBMWithOffset
+ * chooses the smallest encoding. A policy may
+ * instead favor the encodings that are faster
+ * to read back by dbm_relationWithMinDBM, or a
+ * blend of both. The read costs are measured
+ * per dimension on the first DBMs that a policy
+ * encodes for that dimension.
+ **********************************************/
+
+/** Objective of an encoding policy.
+ */
+typedef enum {
+    dbm_MINDBM_FOR_SIZE,  /**< smallest encoding           */
+    dbm_MINDBM_FOR_SPEED, /**< fastest relation            */
+    dbm_MINDBM_FOR_BLEND  /**< weighted sum of both ratios */
+} objectiveOfMinDBM_t;
+
+/** Statistics of a policy for one dimension, indexed by the
+ * encodings copy, bit matrix, and couples (i,j).
+ */
+typedef struct
+{
+    size_t nbWritten[3];   /**< number of mingraphs written          */
+    size_t sizeWritten[3]; /**< their total size in int32_t          */
+    double readCost[3];    /**< time of dbm_relationWithMinDBM per
+                                constraint read, in ns, 0 if unknown */
+    size_t nbMeasured;     /**< number of DBMs measured              */
+} statsOfMinDBMPolicy_t;
+
+/** Opaque type of an encoding policy.
+ */
+typedef struct mingraph_policy_s mingraph_policy_t;
+
+/** Create a policy.
+ * @param objective: what to optimize.
+ * @param speedWeight: for dbm_MINDBM_FOR_BLEND, weight in [0,1]
+ * of the speed, the size has weight 1-speedWeight.
+ * @return a new policy, to delete with dbm_deleteMinDBMPolicy.
+ */
+mingraph_policy_t* dbm_newMinDBMPolicy(objectiveOfMinDBM_t objective, double speedWeight);
+
+/** Delete a policy. The mingraphs written with it are unaffected.
+ */
+void dbm_deleteMinDBMPolicy(mingraph_policy_t* policy);
+
+/** Measure the read costs of the encodings on given DBMs,
+ * replacing the costs measured so far for their dimension.
+ * The constraints are on 16 bits when they fit, as written
+ * with tryConstraints16.
+ * @param policy: the policy to tune.
+ * @param dbms: nbDBMs closed and non empty DBMs of dimension dim.
+ * @param nbDBMs: number of DBMs.
+ * @param dim: dimension.
+ */
+void dbm_calibrateMinDBMPolicy(mingraph_policy_t* policy, const raw_t* dbms, size_t nbDBMs, cindex_t dim);
+
+/** Save a DBM with its minimal graph encoded as chosen by a policy.
+ * @param policy: the policy, updated with statistics.
+ * @param dbm,dim,tryConstraints16,c_alloc,offset: as for
+ * dbm_writeToMinDBMWithOffset with minimizeGraph = true.
+ * @return allocated memory, the mingraph is at offset. It is
+ * read with the usual functions.
+ */
+int32_t* dbm_writeToMinDBMWithPolicy(mingraph_policy_t* policy, const raw_t* dbm, cindex_t dim,
+                                     bool tryConstraints16, allocator_t c_alloc, size_t offset);
+
+/** @return the statistics of a policy for a dimension,
+ * or NULL if it has not encoded or measured that dimension.
+ */
+const statsOfMinDBMPolicy_t* dbm_getStatsOfMinDBMPolicy(const mingraph_policy_t* policy, cindex_t dim);
+
 /** Simple type to allow for statistics on the different internal
  * formats used. The format are not user controllable and should
  * not be read from outside. For the tuple representation, it is
@@ -417,6 +758,9 @@ typedef enum {
     dbm_MINDBM_COPY16,      /**< 16 bits, dbm copy without diagonal */
     dbm_MINDBM_BITMATRIX16, /**< 16 bits, c_ij and a bit matrix     */
     dbm_MINDBM_TUPLES16,    /**< 16 bits, c_ij and tuples (i,j)     */
+    dbm_MINDBM_DELTA32,     /**< 32 bits, c_ij and i*dim+j vs base  */
+    dbm_MINDBM_DELTA16,     /**< 16 bits, c_ij and i*dim+j vs base  */
+    dbm_MINDBM_DICT,        /**< dictionary references and literals */
     dbm_MINDBM_ERROR        /**< should never be the case */
 } representationOfMinDBM_t;
 
@@ -15,6 +15,7 @@
 #define INCLUDE_DBM_PARTITION_H
 
 #include "dbm/fed.h"
+#include "dbm/reduction.h"
 #include "base/intutils.h"
 
 /**
@@ -98,6 +99,12 @@ namespace dbm
          */
         void add(uintptr_t id, fed_t& fed);
 
+        /// @return the policy used to reduce the federations
+        /// of all the partitions, to configure it or read
+        /// its statistics. It applies mergeReduce only unless
+        /// escalations are enabled with setStrategies.
+        static reducer_t& getReducer();
+
         /** @return the federation corresponding to the
          * subset 'id' of the partition. If there is no
          * such subset, an empty federation is returned.
@@ -0,0 +1,103 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : pipeline.h
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_DBM_PIPELINE_H
+#define INCLUDE_DBM_PIPELINE_H
+
+#include "dbm/fed.h"
+
+#include <vector>
+
+/**
+ * @file The type pipeline_t queues unary operations on a federation
+ * and applies them in one pass over its DBMs: every DBM goes through
+ * all the operations before the next one is touched, and a DBM that
+ * becomes empty is removed at once and skips the remaining operations.
+ * The reduction, if any, is done once at the end.
+ *
+ * The operations are applied by apply() or when the pipeline is
+ * destroyed, so that a whole sequence can be written as one statement:
+ *
+ *   pipeline_t(fed).up().constrain(1, 0, 10, false).extrapolateLUBounds(l, u).mergeReduce();
+ *
+ * The federation must not be used while operations are pending.
+ * The result is the same as calling the operations of fed_t one
+ * after the other.
+ */
+
+namespace dbm
+{
+    class pipeline_t
+    {
+    public:
+        /// Queue operations for fed.
+        explicit pipeline_t(fed_t& fed): fed(fed) {}
+
+        /// Apply the pending operations.
+        ~pipeline_t() { apply(); }
+
+        pipeline_t(const pipeline_t&) = delete;
+        pipeline_t& operator=(const pipeline_t&) = delete;
+
+        /// Same operations as fed_t. The bounds of the
+        /// extrapolations are copied.
+        pipeline_t& up();
+        pipeline_t& down();
+        pipeline_t& freeClock(cindex_t clock);
+        pipeline_t& updateValue(cindex_t x, int32_t v);
+        pipeline_t& constrain(cindex_t i, cindex_t j, raw_t c);
+        pipeline_t& constrain(cindex_t i, cindex_t j, int32_t b, bool isStrict)
+        {
+            return constrain(i, j, dbm_boundbool2raw(b, isStrict));
+        }
+        pipeline_t& constrain(const constraint_t& c) { return constrain(c.i, c.j, c.value); }
+        pipeline_t& extrapolateMaxBounds(const int32_t* max);
+        pipeline_t& extrapolateLUBounds(const int32_t* lower, const int32_t* upper);
+
+        /// Reduction done after the operations, the last one wins.
+        pipeline_t& reduce();
+        pipeline_t& mergeReduce();
+        pipeline_t& convexReduce();
+
+        /// @return the number of pending operations.
+        size_t size() const { return ops.size(); }
+
+        /// Apply the pending operations and the reduction.
+        /// @return the federation.
+        fed_t& apply();
+
+    private:
+        enum op_kind_t { UP, DOWN, FREE_CLOCK, UPDATE_VALUE, CONSTRAIN, EXTRAPOLATE_MAX, EXTRAPOLATE_LU };
+        enum reduction_t { NO_REDUCE, REDUCE, MERGE_REDUCE, CONVEX_REDUCE };
+
+        struct op_t
+        {
+            op_kind_t kind;
+            cindex_t i, j;
+            int32_t value;  //< value or constraint or offset in bounds
+        };
+
+        /// Apply the operations to one DBM.
+        /// @return false if it is empty.
+        bool apply(dbm_t& dbm) const;
+
+        /// Copy bounds of the dimension of fed.
+        /// @return their offset in bounds.
+        int32_t copyBounds(const int32_t* values);
+
+        fed_t& fed;
+        std::vector<op_t> ops;
+        std::vector<int32_t> bounds;  //< for the extrapolations
+        reduction_t reduction = NO_REDUCE;
+    };
+}  // namespace dbm
+
+#endif  // INCLUDE_DBM_PIPELINE_H
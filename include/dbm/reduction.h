@@ -0,0 +1,120 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : reduction.h
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_DBM_REDUCTION_H
+#define INCLUDE_DBM_REDUCTION_H
+
+#include "dbm/fed.h"
+
+/**
+ * @file The type reducer_t chooses among the reductions of fed_t.
+ * By default it applies mergeReduce only. When escalations are
+ * enabled, it starts with a cheap reduction and escalates to the
+ * more expensive ones while the federation is still large, the time
+ * budget is not spent, and the next reduction has removed enough
+ * DBMs so far:
+ *
+ *   reducer_t reducer;
+ *   reducer.setStrategies(reducer_t::MERGE_REDUCE, reducer_t::EXPENSIVE_CONVEX_REDUCE);
+ *   reducer.setBudget(0.001);
+ *   reducer.reduce(fed);
+ *
+ * A reduction that did not pay off is skipped, but it is still tried
+ * once in a while in case the federations change. The statistics
+ * are per reducer.
+ */
+
+namespace dbm
+{
+    class reducer_t
+    {
+    public:
+        /// The reductions of fed_t, from the cheapest to the most expensive.
+        enum strategy_t {
+            REDUCE,                   //< fed_t::reduce()
+            MERGE_REDUCE,             //< fed_t::mergeReduce()
+            CONVEX_REDUCE,            //< fed_t::convexReduce()
+            PARTITION_REDUCE,         //< fed_t::partitionReduce()
+            EXPENSIVE_REDUCE,         //< fed_t::expensiveReduce()
+            EXPENSIVE_CONVEX_REDUCE,  //< fed_t::expensiveConvexReduce()
+            NB_STRATEGIES
+        };
+
+        /// What a strategy gave, summed over its calls.
+        struct stats_t
+        {
+            size_t calls;    //< times it was applied
+            size_t skipped;  //< times it was not worth it
+            size_t before;   //< DBMs before
+            size_t after;    //< DBMs after
+            double seconds;  //< time spent
+        };
+
+        /// Default policy: mergeReduce only, without time limit.
+        /// Escalations are enabled with setStrategies.
+        reducer_t() = default;
+
+        /// Reduce fed with the first strategy and escalate.
+        /// @param skip is the number of DBMs already reduced, for the
+        /// incremental reductions of mergeReduce, @see fed_t.
+        /// @return fed.
+        fed_t& reduce(fed_t& fed, size_t skip = 0);
+
+        /// Strategies to use: the first is always applied, the
+        /// following ones up to last are escalations.
+        /// @pre first <= last < NB_STRATEGIES.
+        void setStrategies(strategy_t first, strategy_t last);
+
+        /// Time allowed per call to reduce, in seconds, 0 for no limit.
+        /// The budget is checked between strategies and it bounds
+        /// mergeReduce and the expensive reductions, @see budget.h.
+        void setBudget(double seconds) { budget = seconds; }
+
+        /// Escalate only for federations of at least minSize DBMs.
+        void setEscalationSize(size_t minSize) { escalationSize = minSize; }
+
+        /// Use expensiveReduce and expensiveConvexReduce only if the
+        /// number of DBMs times the dimension is at most maxWork.
+        void setMaxWork(size_t max) { maxWork = max; }
+
+        /// Minimal ratio of DBMs an escalation must remove on average
+        /// to be tried every time.
+        void setMinShrink(double ratio) { minShrink = ratio; }
+
+        /// @return the statistics of a strategy.
+        const stats_t& getStats(strategy_t strategy) const
+        {
+            assert(strategy < NB_STRATEGIES);
+            return stats[strategy];
+        }
+
+        /// Reset the statistics, and what the reducer learnt.
+        void resetStats();
+
+    private:
+        /// @return true if strategy should be tried on fed.
+        bool isWorth(strategy_t strategy, const fed_t& fed);
+
+        /// Apply strategy to fed within limit and record its effect.
+        /// @return the time spent, in seconds.
+        double apply(strategy_t strategy, fed_t& fed, size_t skip, budget_t& limit);
+
+        strategy_t first = MERGE_REDUCE;
+        strategy_t last = MERGE_REDUCE;
+        double budget = 0;
+        size_t escalationSize = 16;
+        size_t maxWork = 1024;
+        double minShrink = 0.05;
+        stats_t stats[NB_STRATEGIES]{};
+    };
+}  // namespace dbm
+
+#endif  // INCLUDE_DBM_REDUCTION_H
@@ -0,0 +1,175 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : zonestore.h
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_DBM_ZONESTORE_H
+#define INCLUDE_DBM_ZONESTORE_H
+
+#include "dbm/mingraph.h"
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file The type zonestore_t stores zones as minimal graphs
+ * in buckets indexed by a given key (typically the discrete
+ * part of a state). When the zones kept in memory exceed a
+ * given size, the least recently used buckets are spilled to
+ * append-only segment files on the local disk, which are read
+ * back through mmap. Every bucket keeps the bounds of its zones
+ * on the clocks in memory so that most inclusion misses are
+ * decided without reading the spilled zones. Optionally, the
+ * zones share a dictionary of their frequent constraints (see
+ * dbm_writeToDictMinDBMWithOffset).
+ */
+
+namespace dbm
+{
+    class zonestore_t
+    {
+    public:
+        /** Initialise an empty store.
+         * @param dim: dimension of the zones.
+         * @param directory: where to create the segment files.
+         * @param maxResident: maximal size (in int32_t) of the
+         * zones kept in memory.
+         * @param segmentSize: size (in int32_t) after which a
+         * new segment file is started.
+         * @param dictThreshold: if > 0, the zones are saved with a
+         * dictionary of the constraints seen dictThreshold times,
+         * which lives as long as the store.
+         */
+        zonestore_t(cindex_t dim, std::string directory, size_t maxResident, size_t segmentSize = 1 << 24,
+                    uint32_t dictThreshold = 0);
+
+        /// Unmap and remove the segment files, delete the dictionary.
+        ~zonestore_t();
+
+        zonestore_t(const zonestore_t&) = delete;
+        zonestore_t& operator=(const zonestore_t&) = delete;
+
+        /** Add a zone to the bucket 'key' unless it is included
+         * in a zone of this bucket. The zones of the bucket that
+         * are in memory and included in dbm are removed.
+         * @param key: bucket of the zone.
+         * @param dbm: the zone.
+         * @return true if dbm was added.
+         * @pre dbm is closed, not empty, and a raw_t[dim*dim].
+         * @throw std::runtime_error if a segment cannot be written.
+         */
+        bool add(uintptr_t key, const raw_t* dbm);
+
+        /** @return true if dbm is included in a zone of the
+         * bucket 'key', in memory or spilled.
+         * @pre dbm is closed, not empty, and a raw_t[dim*dim].
+         * @throw std::runtime_error if a segment cannot be read.
+         */
+        bool contains(uintptr_t key, const raw_t* dbm);
+
+        /// Spill all the buckets that have zones in memory.
+        void spill();
+
+        /// @return the dimension of the zones.
+        cindex_t getDimension() const { return dim; }
+
+        /// @return the number of zones, in memory or spilled.
+        size_t getNumberOfZones() const { return nbZones; }
+
+        /// @return the size (in int32_t) of the zones in memory.
+        size_t getResidentSize() const { return residentSize; }
+
+        /// @return the size (in int32_t) of the spilled zones.
+        size_t getSpilledSize() const { return spilledSize; }
+
+        /// @return the number of segment files.
+        size_t getNumberOfSegments() const { return segments.size(); }
+
+        /// @return the dictionary of the zones or nullptr.
+        const mingraph_dict_t* getDictionary() const { return dict; }
+
+        /// Counters of the inclusion checks.
+        struct stats_t
+        {
+            size_t lookups;         //< calls to contains
+            size_t summaryRejects;  //< misses decided by the bounds of a bucket
+            size_t diskLookups;     //< lookups that read spilled zones
+            size_t diskHits;        //< zones found in spilled zones
+            size_t spills;          //< buckets spilled
+        };
+
+        /// @return the counters of the inclusion checks.
+        const stats_t& getStats() const { return stats; }
+
+    private:
+        /// Zones written in one go to a segment.
+        struct extent_t
+        {
+            uint32_t segment;  //< index of the segment
+            size_t offset;     //< offset in int32_t in the segment
+            size_t size;       //< size in int32_t
+        };
+
+        struct bucket_t
+        {
+            std::vector<int32_t*> zones;       //< zones in memory
+            std::vector<extent_t> spilled;     //< spilled zones
+            std::vector<raw_t> bounds;         //< max of dbm[i,0] then dbm[0,i]
+            size_t residentSize = 0;           //< size of zones in int32_t
+            std::list<uintptr_t>::iterator lru;  //< valid iff residentSize > 0
+        };
+
+        struct segment_t
+        {
+            std::string path;
+            size_t size;              //< written size in int32_t
+            const int32_t* data;      //< mapped data or nullptr
+            size_t mapped;            //< mapped size in int32_t
+            std::vector<int32_t> copy;  //< data when mmap is not available
+        };
+
+        /// @return the relation between dbm and a zone, with the dictionary if any.
+        relation_t relation(const raw_t* dbm, const int32_t* zone, raw_t* unpackBuffer) const;
+
+        /// @return true if the bounds of the bucket allow dbm to be included.
+        bool mayContain(const bucket_t& bucket, const raw_t* dbm) const;
+
+        /// Mark a bucket as the most recently used.
+        void touch(uintptr_t key, bucket_t& bucket);
+
+        /// Spill the least recently used buckets while residentSize > maxResident.
+        void evict();
+
+        /// Write the zones of a bucket to the current segment.
+        void spill(bucket_t& bucket);
+
+        /// @return the data of an extent, mapping its segment if needed.
+        const int32_t* read(const extent_t& extent);
+
+        /// Map the written part of a segment.
+        void map(segment_t& segment);
+        void unmap(segment_t& segment);
+
+        cindex_t dim;
+        std::string directory;
+        size_t maxResident, segmentSize;
+        size_t nbZones = 0, residentSize = 0, spilledSize = 0;
+        std::unordered_map<uintptr_t, bucket_t> buckets;
+        std::list<uintptr_t> lru;  //< buckets with zones in memory, least recent first
+        std::vector<segment_t> segments;
+        std::vector<raw_t> buffer;  //< to unpack zones
+        mingraph_dict_t* dict;      //< shared constraints or nullptr
+        stats_t stats{};
+    };
+}  // namespace dbm
+
+#endif  // INCLUDE_DBM_ZONESTORE_H
@@ -13,6 +13,8 @@
 
 #include "DBMAllocator.h"
 
+#include <algorithm>
+
 namespace dbm
 {
     // Instances.
@@ -23,17 +25,71 @@ namespace dbm
 #ifndef ENABLE_DBM_NEW
     DBMAllocator& DBMAllocator::instance() { return DBMAllocator::dbm_allocator; }
 
+    void DBMAllocator::reserve(cindex_t dim, size_t n)
+    {
+        if (freeList.size() <= dim)
+            freeList.resize(dim + 1);
+        auto& list = freeList[dim];
+        for (auto it = list.begin(); n > 0 && it != list.end(); ++it) {
+            --n;
+        }
+        if (n < 2) {
+            return;  // not worth a slab
+        }
+        size_t size = intSize(dim);
+        auto* start = new int32_t[n * size];
+        for (size_t k = n; k-- > 0;) {  // in memory order
+            list.push_front(reinterpret_cast<idbm_t*>(start + k * size));
+        }
+        slab_t slab{start, start + n * size, n};
+        slabs.insert(std::upper_bound(slabs.begin(), slabs.end(), slab,
+                                      [](const slab_t& a, const slab_t& b) { return a.start < b.start; }),
+                     slab);
+    }
+
     /* Go through the list of deallocated DBMs
      * and delete them all (ie really free memory).
+     * The DBMs of a slab are deleted only when all of
+     * them are deallocated, the others are kept.
      */
     void DBMAllocator::cleanUp()
     {
+        std::vector<size_t> deallocated(slabs.size());
+        auto slabOf = [&](idbm_t* dbm) {
+            auto* ptr = reinterpret_cast<int32_t*>(dbm);
+            auto it = std::upper_bound(slabs.begin(), slabs.end(), ptr,
+                                       [](int32_t* p, const slab_t& slab) { return p < slab.start; });
+            return it != slabs.begin() && ptr < (it - 1)->end ? (size_t)(it - slabs.begin() - 1) : slabs.size();
+        };
         for (auto& list : freeList) {
             for (auto* dbm : list) {
-                delete[] reinterpret_cast<int32_t*>(dbm);
+                size_t k = slabOf(dbm);
+                if (k == slabs.size()) {
+                    delete[] reinterpret_cast<int32_t*>(dbm);
+                } else {
+                    deallocated[k]++;
+                }
             }
         }
-        freeList.clear();
+        if (slabs.empty()) {
+            freeList.clear();
+            return;
+        }
+        for (auto& list : freeList) {
+            list.remove_if([&](idbm_t* dbm) {
+                size_t k = slabOf(dbm);
+                return k == slabs.size() || deallocated[k] == slabs[k].size;
+            });
+        }
+        size_t kept = 0;
+        for (size_t k = 0; k < slabs.size(); ++k) {
+            if (deallocated[k] == slabs[k].size) {
+                delete[] slabs[k].start;
+            } else {
+                slabs[kept++] = slabs[k];
+            }
+        }
+        slabs.resize(kept);
     }
 
     ///< Wrapper function
@@ -46,6 +102,9 @@ namespace dbm
         DBMAllocator::instance().dealloc(dbm);
     }
 
+    ///< Wrapper function
+    void dbm_reserve(cindex_t dim, size_t n) { DBMAllocator::instance().reserve(dim, n); }
+
     ///< Wrapper function
     void cleanUp() { DBMAllocator::instance().cleanUp(); }
 
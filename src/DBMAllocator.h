@@ -55,13 +55,15 @@ namespace dbm
                     return dbm;
                 }
             }
-#ifdef ENABLE_STORE_MINGRAPH
-            return new int32_t[intSizeOf(idbm_t) + dim * dim + bits2intsize(dim * dim)];
-#else
-            return new int32_t[intSizeOf(idbm_t) + dim * dim];
-#endif
+            return new int32_t[intSize(dim)];
         }
 
+        /** Make sure that the next n allocations of DBMs of
+         * dimension dim are served by the free list, allocating
+         * the missing ones in one slab.
+         */
+        void reserve(cindex_t dim, size_t n);
+
         /** Deallocate an idbm_t
          * @param dbm: dbm to deallocate
          */
@@ -91,7 +93,29 @@ namespace dbm
         static DBMAllocator& instance();
 
     private:
+        /// Size of an idbm_t in int32_t, rounded up so that
+        /// the idbm_t of a slab are aligned too.
+        static size_t intSize(cindex_t dim)
+        {
+            constexpr size_t align = alignof(idbm_t) / sizeof(int32_t);
+            // matrix, [mingraph,] upper bounds
+#ifdef ENABLE_STORE_MINGRAPH
+            size_t size = intSizeOf(idbm_t) + dim * dim + bits2intsize(dim * dim) + dim;
+#else
+            size_t size = intSizeOf(idbm_t) + dim * dim + dim;
+#endif
+            return align > 1 ? (size + align - 1) / align * align : size;
+        }
+
+        struct slab_t
+        {
+            int32_t* start;  //< as allocated
+            int32_t* end;
+            size_t size;  //< number of idbm_t
+        };
+
         std::vector<std::forward_list<idbm_t*>> freeList;
+        std::vector<slab_t> slabs;  //< sorted by start
         dbm_t dbm1x1;
         static DBMAllocator dbm_allocator;
     };
@@ -0,0 +1,117 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : FedIndex.cpp
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "FedIndex.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace dbm
+{
+    FedIndex::FedIndex(const fdbm_t* head, size_t size, cindex_t d):
+        dim(d), dbms(size), bounds(2 * d * size), order(size)
+    {
+        assert(dim > 1);
+        raw_t* b = bounds.data();
+        for (uint32_t k = 0; k < size; ++k, head = head->getNext(), b += 2 * dim) {
+            assert(head);
+            const dbm_t& dbm = head->const_dbmt();
+            dbms[k] = &dbm;
+            std::memcpy(b, dbm.getUpperBounds(), dim * sizeof(raw_t));
+            std::memcpy(b + dim, dbm.const_dbm(), dim * sizeof(raw_t));
+            order[k] = k;
+        }
+        assert(head == nullptr);
+        if (size > 0) {
+            nodes.reserve(2 * size / LEAF_SIZE + 1);
+            build(0, size);
+        }
+    }
+
+    // Median split along the clock where the centers of the
+    // bounds spread the most. Infinite upper bounds count as
+    // their lower bounds so that they do not hide the spread.
+    uint32_t FedIndex::build(uint32_t begin, uint32_t end)
+    {
+        uint32_t n = nodes.size();
+        nodes.push_back({begin, end, 0, 0});
+        boxes.resize(boxes.size() + 2 * dim);
+
+        raw_t* box = &boxes[2 * dim * n];
+        std::memcpy(box, entryBounds(order[begin]), 2 * dim * sizeof(raw_t));
+        for (uint32_t i = begin + 1; i < end; ++i) {
+            const raw_t* b = entryBounds(order[i]);
+            for (cindex_t j = 0; j < 2 * dim; ++j) {
+                box[j] = std::max(box[j], b[j]);
+            }
+        }
+        if (end - begin <= LEAF_SIZE) {
+            return n;
+        }
+
+        auto center = [this](uint32_t k, cindex_t i) {
+            const raw_t* b = entryBounds(k);
+            int64_t lower = -dbm_raw2bound(b[dim + i]);
+            return b[i] == dbm_LS_INFINITY ? 2 * lower : lower + dbm_raw2bound(b[i]);
+        };
+        cindex_t axis = 1;
+        int64_t spread = -1;
+        for (cindex_t i = 1; i < dim; ++i) {
+            int64_t lo = center(order[begin], i), hi = lo;
+            for (uint32_t k = begin + 1; k < end; ++k) {
+                int64_t c = center(order[k], i);
+                lo = std::min(lo, c);
+                hi = std::max(hi, c);
+            }
+            if (hi - lo > spread) {
+                spread = hi - lo;
+                axis = i;
+            }
+        }
+        uint32_t mid = begin + (end - begin) / 2;
+        std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                         [&](uint32_t a, uint32_t b) { return center(a, axis) < center(b, axis); });
+
+        uint32_t left = build(begin, mid);
+        uint32_t right = build(mid, end);
+        nodes[n].left = left;
+        nodes[n].right = right;
+        return n;
+    }
+
+    bool FedIndex::isValid(const fdbm_t* head, size_t size) const
+    {
+        if (size != dbms.size()) {
+            return false;
+        }
+        const raw_t* b = bounds.data();
+        for (size_t k = 0; k < size; ++k, head = head->getNext(), b += 2 * dim) {
+            const dbm_t& dbm = head->const_dbmt();
+            if (&dbm != dbms[k] || std::memcmp(b, dbm.getUpperBounds(), dim * sizeof(raw_t)) != 0 ||
+                std::memcmp(b + dim, dbm.const_dbm(), dim * sizeof(raw_t)) != 0) {
+                return false;
+            }
+        }
+        return head == nullptr;
+    }
+
+    std::vector<size_t> FedIndex::overlapping(const raw_t* dbm) const
+    {
+        std::vector<size_t> result;
+        search([&](const raw_t* upper, const raw_t* lower) { return disjoint(upper, lower, dbm, dim); },
+               [&](size_t k, const dbm_t&) {
+                   result.push_back(k);
+                   return false;
+               });
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+}  // namespace dbm
@@ -0,0 +1,129 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : FedIndex.h
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef DBM_FEDINDEX_H
+#define DBM_FEDINDEX_H
+
+#include "dbm/fed.h"
+
+#include <vector>
+
+/** @file
+ * Spatial index of the DBMs of a federation: a bounding volume
+ * hierarchy over the bounds of the clocks (row 0 and column 0)
+ * of the DBMs. It is built by ifed_t for large federations and
+ * dropped as soon as the federation may change.
+ */
+namespace dbm
+{
+    class FedIndex
+    {
+    public:
+        /** Index a list of DBMs.
+         * @param head,size: the list and its size.
+         * @param dim: dimension of the DBMs, > 1.
+         */
+        FedIndex(const fdbm_t* head, size_t size, cindex_t dim);
+
+        /// @return true if the index matches the list and the bounds
+        /// of its DBMs, for debugging.
+        bool isValid(const fdbm_t* head, size_t size) const;
+
+        /// @return the DBM at a given position of the list.
+        const dbm_t& getDBM(size_t position) const { return *dbms[position]; }
+
+        /** Visit the DBMs whose bounds are not rejected, in no
+         * particular order.
+         * @param reject(upper, lower): true if no DBM with bounds
+         * within upper (column 0) and lower (row 0) is wanted.
+         * @param visit(position, dbm): true to stop the search.
+         * @return true if a visit stopped the search.
+         */
+        template <typename Reject, typename Visit>
+        bool search(Reject reject, Visit visit) const;
+
+        /// @return the positions in the list of the DBMs whose bounds
+        /// intersect those of dbm, in increasing order.
+        std::vector<size_t> overlapping(const raw_t* dbm) const;
+
+        /// @return true if the bounds upper, lower do not intersect
+        /// the bounds of dbm.
+        static bool disjoint(const raw_t* upper, const raw_t* lower, const raw_t* dbm, cindex_t dim)
+        {
+            for (cindex_t i = 1; i < dim; ++i) {
+                if ((upper[i] != dbm_LS_INFINITY && dbm_negRaw(upper[i]) >= dbm[i]) ||
+                    (dbm[i * dim] != dbm_LS_INFINITY && dbm_negRaw(dbm[i * dim]) >= lower[i])) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        enum { LEAF_SIZE = 8 };
+
+        /// Node of the tree, a leaf if right == 0.
+        struct node_t
+        {
+            uint32_t begin, end;  //< range of 'order' covered
+            uint32_t left, right; //< children
+        };
+
+        /// Build the node covering order[begin,end).
+        /// @return its index.
+        uint32_t build(uint32_t begin, uint32_t end);
+
+        /// Bounds of an entry or a node: upper then lower.
+        const raw_t* entryBounds(size_t k) const { return &bounds[2 * dim * k]; }
+        const raw_t* nodeBounds(size_t n) const { return &boxes[2 * dim * n]; }
+
+        cindex_t dim;
+        std::vector<const dbm_t*> dbms;  //< DBMs by position in the list
+        std::vector<raw_t> bounds;       //< their bounds when indexed
+        std::vector<uint32_t> order;     //< positions sorted by the tree
+        std::vector<node_t> nodes;       //< root is 0
+        std::vector<raw_t> boxes;        //< bounds of the nodes
+    };
+
+    template <typename Reject, typename Visit>
+    bool FedIndex::search(Reject reject, Visit visit) const
+    {
+        if (nodes.empty()) {
+            return false;
+        }
+        uint32_t stack[64];  // depth <= log2(2^32/LEAF_SIZE)
+        size_t top = 0;
+        stack[top++] = 0;
+        do {
+            uint32_t n = stack[--top];
+            const raw_t* box = nodeBounds(n);
+            if (reject(box, box + dim)) {
+                continue;
+            }
+            const node_t& node = nodes[n];
+            if (node.right == 0) {
+                for (uint32_t i = node.begin; i < node.end; ++i) {
+                    uint32_t k = order[i];
+                    const raw_t* b = entryBounds(k);
+                    if (!reject(b, b + dim) && visit(k, *dbms[k])) {
+                        return true;
+                    }
+                }
+            } else {
+                stack[top++] = node.right;
+                stack[top++] = node.left;
+            }
+        } while (top != 0);
+        return false;
+    }
+}  // namespace dbm
+
+#endif  // DBM_FEDINDEX_H
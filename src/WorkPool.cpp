@@ -0,0 +1,143 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : WorkPool.cpp
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "WorkPool.h"
+
+#include <cassert>
+
+namespace dbm
+{
+    WorkPool::WorkPool(size_t nbThreads): ranges(new range_t[nbThreads > 0 ? nbThreads : 1])
+    {
+        for (size_t id = 1; id < nbThreads; ++id) {
+            workers.emplace_back(&WorkPool::loop, this, id);
+        }
+    }
+
+    WorkPool::~WorkPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        started.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void WorkPool::run(size_t nbTasks, const std::function<void(size_t)>& task)
+    {
+        if (workers.empty() || nbTasks <= 1) {
+            for (size_t k = 0; k < nbTasks; ++k) {
+                task(k);
+            }
+            return;
+        }
+
+        size_t nbThreads = getNbThreads();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t id = 0; id < nbThreads; ++id) {
+                ranges[id].begin = nbTasks * id / nbThreads;
+                ranges[id].end = nbTasks * (id + 1) / nbThreads;
+            }
+            job = &task;
+            error = nullptr;
+            running = workers.size();
+            generation++;
+        }
+        started.notify_all();
+        work(0);
+
+        std::exception_ptr failure;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [this] { return running == 0; });
+            job = nullptr;
+            failure = error;
+            error = nullptr;
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    // Own tasks are taken from the beginning of the range,
+    // stolen tasks from the end of the range of the victim.
+    bool WorkPool::next(size_t id, size_t& index)
+    {
+        range_t& own = ranges[id];
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.begin < own.end) {
+                index = own.begin++;
+                return true;
+            }
+        }
+        size_t nbThreads = getNbThreads();
+        for (size_t k = 1; k < nbThreads; ++k) {
+            range_t& victim = ranges[(id + k) % nbThreads];
+            size_t begin, end;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.begin >= victim.end) {
+                    continue;
+                }
+                begin = victim.begin + (victim.end - victim.begin) / 2;
+                end = victim.end;
+                victim.end = begin;
+            }
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.begin = begin + 1;
+            own.end = end;
+            index = begin;
+            return true;
+        }
+        return false;
+    }
+
+    void WorkPool::work(size_t id)
+    {
+        size_t index;
+        while (next(id, index)) {
+            try {
+                (*job)(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void WorkPool::loop(size_t id)
+    {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                started.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            work(id);
+            std::lock_guard<std::mutex> lock(mutex);
+            assert(running > 0);
+            if (--running == 0) {
+                finished.notify_one();
+            }
+        }
+    }
+}  // namespace dbm
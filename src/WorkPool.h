@@ -0,0 +1,88 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : WorkPool.h
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef DBM_WORKPOOL_H
+#define DBM_WORKPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** @file
+ * Pool of threads to run independent tasks in parallel. The tasks
+ * are numbered from 0 and split in ranges, one per thread. A thread
+ * that is done with its range steals the upper half of the range
+ * of another thread. The calling thread takes part in the work.
+ *
+ * The tasks must not touch the shared state of the library, i.e.,
+ * the allocators of fdbm_t, ifed_t, idbm_t and the table of hashed
+ * DBMs, which are not thread safe: they compute on raw DBMs only.
+ */
+namespace dbm
+{
+    class WorkPool
+    {
+    public:
+        /// @param nbThreads: number of threads, including the caller.
+        explicit WorkPool(size_t nbThreads);
+
+        /// Stop and join the threads.
+        ~WorkPool();
+
+        WorkPool(const WorkPool&) = delete;
+        WorkPool& operator=(const WorkPool&) = delete;
+
+        /// @return the number of threads, including the caller.
+        size_t getNbThreads() const { return workers.size() + 1; }
+
+        /** Run task(0) .. task(nbTasks-1) and wait for all of them.
+         * @param task: must not call run.
+         * @throw the first exception thrown by a task, after
+         * all the tasks have run.
+         */
+        void run(size_t nbTasks, const std::function<void(size_t)>& task);
+
+    private:
+        /// Tasks [begin,end) left to one thread.
+        struct range_t
+        {
+            std::mutex mutex;
+            size_t begin = 0, end = 0;
+        };
+
+        /// Take the next task of thread 'id' or steal some.
+        /// @return false if there is nothing left.
+        bool next(size_t id, size_t& index);
+
+        /// Run tasks until there is nothing left.
+        void work(size_t id);
+
+        /// Main loop of the worker thread 'id'.
+        void loop(size_t id);
+
+        std::vector<std::thread> workers;
+        std::unique_ptr<range_t[]> ranges;  //< one per thread, 0 is the caller
+        std::mutex mutex;                   //< protects the fields below
+        std::condition_variable started, finished;
+        const std::function<void(size_t)>* job = nullptr;
+        uint64_t generation = 0;  //< incremented for every job
+        size_t running = 0;       //< workers busy with the job
+        bool stopping = false;
+        std::exception_ptr error;
+    };
+}  // namespace dbm
+
+#endif  // DBM_WORKPOOL_H
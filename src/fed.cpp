@@ -12,9 +12,12 @@
 ///////////////////////////////////////////////////////////////////
 
 #include "DBMAllocator.h"
+#include "FedIndex.h"
+#include "WorkPool.h"
 #include "dbm.h"
 #include "mingraph_coding.h"
 
+#include "dbm/budget.h"
 #include "dbm/config.h"
 #include "dbm/mingraph.h"
 #include "dbm/print.h"
@@ -22,10 +25,14 @@
 #include <base/bitstring.h>
 #include <base/doubles.h>
 
-#include <algorithm>  // find_if
+#include <algorithm>  // find_if, min
 #include <forward_list>
+#include <list>
+#include <memory>
 #include <sstream>
+#include <unordered_map>
 #include <cmath>
+#include <vector>
 
 // This is to print how some DBM reductions perform.
 #if defined(SHOW_STATS) && defined(VERBOSE)
@@ -41,23 +48,17 @@
 //#define PARTITION_FIXPOINT
 
 // Variants for subtractions:
-// - desactive disjoint: #define NDISJOINT_SUBTRACTION
-// - different algorithm: #define SUBTRACTION_ALGORITHM x
-//   where x=0 => minimal graph only
-//         x=1 => try to skip non intersecting facettes
-//         x=2 => reordering of constraints
-//         x=3 => reordering of constraints + skip intersecting facettes
+// - desactive disjoint for the operators: #define NDISJOINT_SUBTRACTION
+//   (fed_t::subtract(arg, disjoint) chooses per call)
+// - the order of the splits is chosen at runtime, see fed_t::subtractionStrategy
 
 //#define NDISJOINT_SUBTRACTION
-//#define SUBTRACTION_ALGORITHM 0
-//#define SUBTRACTION_ALGORITHM 1
-//#define SUBTRACTION_ALGORITHM 2
-//#define SUBTRACTION_ALGORITHM 3
-
-// Default subtraction.
-#ifndef SUBTRACTION_ALGORITHM
-// NOLINTNEXTLINE
-#define SUBTRACTION_ALGORITHM 3
+
+#ifdef NDISJOINT_SUBTRACTION
+#warning "Subtraction: Result not disjoint."
+static constexpr bool disjoint_subtraction = false;
+#else
+static constexpr bool disjoint_subtraction = true;
 #endif
 
 namespace dbm
@@ -66,144 +67,136 @@ namespace dbm
     const fed_t::const_iterator fed_t::const_iterator::ENDI(nullptr);
     static bool restricted_merge = true;
 
-#ifdef SHOW_STATS
-#define INC() base::stats.count(MAGENTA(BOLD) "DBM: Subtraction splits", nullptr)
-#else
-#define INC()
-#endif
+    // Pool and minimal federation size for parallel subtractions,
+    // no pool means sequential subtractions.
+    static std::unique_ptr<WorkPool> subtraction_pool;
+    static size_t subtraction_threshold = 0;
 
-    /*****************************************
-     * Functions to compute the subtraction.
-     *****************************************/
+    // Same for the operations applied to every DBM (up, constrain...).
+    static std::unique_ptr<WorkPool> operation_pool;
+    static size_t operation_threshold = 0;
+
+    // Minimal size of federations to index, 0 for none.
+    static size_t index_threshold = 0;
 
-#if SUBTRACTION_ALGORITHM == 1
-#warning "Bad subtraction: Skip non intersecting facettes."
+    // Minimal size of both federations to index and hash for
+    // unions, below which it costs more than comparing all the pairs.
+    static constexpr size_t UNION_INDEX_MIN = 64;
 
-    // Approximate test.
-    static inline bool isInside(const raw_t* dbm1, const raw_t* dbm2, cindex_t dim, cindex_t i, cindex_t j)
+    // Table of interned federations by their hash values. Never
+    // deallocated since federations may be destroyed after it.
+    static std::unordered_multimap<uint32_t, ifed_t*>& fed_table()
     {
-        cindex_t k = 0;
-        size_t kdim = 0;
-        size_t idim = i * dim;
-        raw_t dbmij = dbm2[idim + j];
+        static auto* table = new std::unordered_multimap<uint32_t, ifed_t*>();
+        return *table;
+    }
 
-        assert(dim > 1 && i != j && dbmij != dbm_LS_INFINITY);
+    // Memoized results of predt and succt for fixpoint computations
+    // that call them again with unchanged federations.
+    enum predt_kind_t { PREDT, SUCCT };
 
-        do {
-            if (k != i && k != j) {
-                if (dbm2[kdim + j] != dbm_LS_INFINITY && dbm1[idim + k] != dbm_LS_INFINITY) {
-                    if (dbmij - dbm2[kdim + j] > dbm1[idim + k] + 1)
-                        return false;
-                }
-                if (dbm2[idim + k] != dbm_LS_INFINITY && dbm1[kdim + j] != dbm_LS_INFINITY) {
-                    if (dbmij - dbm2[idim + k] > dbm1[kdim + j] + 1)
-                        return false;
-                }
-            }
-            ++k;
-            kdim += dim;
-        } while (k < dim);
+    struct predt_memo_t
+    {
+        uint32_t hash;              //< of the kind and the arguments, see predt_hash
+        std::vector<raw_t> args;    //< kind, dimension, sizes and DBMs of the arguments
+        std::vector<raw_t> result;  //< size and DBMs of the result
+        bool success;               //< of succt
+    };
 
-        return true;
-    }
+    using predt_memo_list_t = std::list<predt_memo_t>;
+    static predt_memo_list_t predt_memo;  //< most recent first
+    static std::unordered_multimap<uint32_t, predt_memo_list_t::iterator> predt_memo_index;  //< by hash
+    static size_t predt_memo_capacity = 0;
 
-    // Subtraction itself using constraints in the minimal graph (bits) only.
-    // Return fdbm1 - dbm2, reading fdbm1 as one DBM and not a list.
-    static dbmlist_t internSubtract(fdbm_t* fdbm1, const raw_t* dbm2, cindex_t dim, const uint32_t* bits,
-                                    size_t bitsSize, size_t nbConstraints)
+    // Forget the least recent memo.
+    static void predt_evict()
     {
-        assert(dim > 1);
-        assertx(dbm_isValid(dbm2, dim));
-        assert(bits && fdbm1 && dbm2);
-        assert(base_countBitsN(bits, bitsSize) == nbConstraints);
+        auto last = std::prev(predt_memo.end());
+        auto range = predt_memo_index.equal_range(last->hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == last) {
+                predt_memo_index.erase(it);
+                break;
+            }
+        }
+        predt_memo.pop_back();
+    }
 
-        uint32_t indices[nbConstraints];
-        dbmlist_t result;
-        raw_t* dbm1 = fdbm1->getMatrix();
-        bool isMutable = false;
-        uint32_t i = 0, j = 0, nb = 0;
-        bool firstPass = true;
+    /// @return the spatial index of a federation or nullptr.
+    static inline const FedIndex* fed_getIndex(const ifed_t* ifed)
+    {
+        return index_threshold != 0 ? ifed->getIndex(index_threshold) : nullptr;
+    }
 
-        if (!nbContraints)
-            return result;
+    /// @return true if a DBM of an indexed federation satisfies
+    /// pred(dbm), looking only at DBMs whose bounds intersect arg.
+    template <typename Pred>
+    static inline bool fed_anyIntersecting(const FedIndex* index, const raw_t* arg, cindex_t dim, Pred pred)
+    {
+        return index->search(
+            [&](const raw_t* upper, const raw_t* lower) { return FedIndex::disjoint(upper, lower, arg, dim); },
+            [&](size_t, const dbm_t& dbm) { return pred(dbm); });
+    }
 
-        for (;;) {
-            /*********************** find constraint i,j to subtract ***************/
-            uint32_t count = 32;
-            for (uint32_t b = *bits++; b != 0; --count, ++j, b >>= 1) {
-                for (; (b & 1) == 0; --count, ++j, b >>= 1)  // look for a bit
-                {
-                    assert(count && b);
-                }
-                FIX_IJ();
-                do {
-                    --nbConstraints;
-
-                    assert(i != j && i < dim && j < dim);
-                    assert(dbm2[i * dim + j] != dbm_LS_INFINITY);  // in the minimal graph
-
-                    /******************* Subtraction for dbm2[i,j] *********************/
-                    if (dbm2[i * dim + j] < dbm1[i * dim + j]) {
-                        raw_t negConstraint = dbm_negRaw(dbm2[i * dim + j]);
-                        if (negConstraint < dbm1[j * dim + i]) {
-                            if (nb == 0 && nbConstraints == 0) {
-                                dbm_tighten(isMutable ? dbm1 : fdbm1->dbmt().getCopy(), dim, j, i, negConstraint);
-                                INC();
-                                return result.append(fdbm1);
-                            }
-                            if (firstPass && !isInside(dbm1, dbm2, dim, i, j)) {
-                                indices[nb] = i | (j << 16);
-                                nb++;
-                            } else {
-                                dbm_tighten(result.append(dbm1, dim), dim, j, i, negConstraint);
-                                INC();
-#ifndef NDISJOINT_SUBTRACTION
-                                if (!isMutable) {
-                                    dbm1 = fdbm1->dbmt().getCopy();
-                                    isMutable = true;
-                                }
-                                dbm_tighten(dbm1, dim, i, j, dbm2[i * dim + j]);  // remainder
+#ifdef SHOW_STATS
+#define INC() base::stats.count(MAGENTA(BOLD) "DBM: Subtraction splits", nullptr)
 #else
-#warning "Subtraction: Result not disjoint."
+#define INC()
 #endif
-                            }
-                        } else {
-                            // dbm2[i,j] < dbm1[i,j] => dbm2 tightens dbm1
-                            // -dbm2[i,j] >= dbm1[j,i] => substraction == remainder
-                            return result.append(fdbm1);
-                        }
-                    }
 
-                    /********************** Finish 1st pass or 2nd pass ************/
-                    if (!nbConstraints) {
-                        if (nb == 0)
-                            goto finish_subtract;
-                        firstPass = false;
-                        nbConstraints = nb;
-                        nb = 0;
-                    }
-                    if (!firstPass) {
-                        i = indices[nbConstraints - 1] & 0xffff;
-                        j = indices[nbConstraints - 1] >> 16;
-                    }
-                } while (!firstPass);
+    /*****************************************
+     * Functions to compute the subtraction.
+     *****************************************/
 
-                /******************* Finish to read constraints i,j ****************/
-                assert(count);
+    // Strategy of the subtractions and what the strategies gave so far,
+    // by classes of dimensions and numbers of constraints (of the minimal
+    // graph of the subtracted DBM) for the adaptive strategy.
+    static fed_t::subtraction_t subtraction_strategy = fed_t::SUBTRACT_WORST;
+    static fed_t::subtraction_stats_t subtraction_stats[4][4][fed_t::SUBTRACT_ADAPTIVE];
+
+    static inline fed_t::subtraction_stats_t* fed_subtractionStats(cindex_t dim, size_t nbConstraints)
+    {
+        size_t d = dim <= 3 ? 0 : dim <= 6 ? 1 : dim <= 12 ? 2 : 3;
+        size_t n = nbConstraints <= 2 ? 0 : nbConstraints <= 4 ? 1 : nbConstraints <= 8 ? 2 : 3;
+        return subtraction_stats[d][n];
+    }
+
+    // The adaptive strategy tries every strategy in at least 1/32 of
+    // the subtractions of a class and otherwise takes the one that gave
+    // the fewest DBMs on average.
+    static inline fed_t::subtraction_t fed_chooseSubtraction(cindex_t dim, size_t nbConstraints)
+    {
+        if (subtraction_strategy != fed_t::SUBTRACT_ADAPTIVE) {
+            return subtraction_strategy;
+        } else if (nbConstraints <= 1) {
+            return fed_t::SUBTRACT_MINGRAPH;  // nothing to order
+        }
+        const fed_t::subtraction_stats_t* stats = fed_subtractionStats(dim, nbConstraints);
+        size_t total = 0;
+        for (int s = 0; s < fed_t::SUBTRACT_ADAPTIVE; ++s) {
+            total += stats[s].calls;
+        }
+        int best = 0;
+        for (int s = 0; s < fed_t::SUBTRACT_ADAPTIVE; ++s) {
+            if (stats[s].calls < 8 || stats[s].calls * 32 < total) {
+                return (fed_t::subtraction_t)s;
+            }
+            if (stats[s].pieces * stats[best].calls < stats[best].pieces * stats[s].calls) {
+                best = s;
             }
-            j += count;  // unread bits
         }
-
-        /************** Deallocate remainder left and return result ****************/
-    finish_subtract:
-        fdbm1->dbmt().nil();
-        fdbm1->remove();
-        return result;
+        return (fed_t::subtraction_t)best;
     }
 
-#elif SUBTRACTION_ALGORITHM >= 2
+    static inline void fed_recordSubtraction(fed_t::subtraction_t strategy, cindex_t dim, size_t nbConstraints,
+                                             size_t nbSplits, size_t nbPieces)
+    {
+        fed_t::subtraction_stats_t& stats = fed_subtractionStats(dim, nbConstraints)[strategy];
+        stats.calls++;
+        stats.splits += nbSplits;
+        stats.pieces += nbPieces;
+    }
 
-#if SUBTRACTION_ALGORITHM == 3
     // Get the worst ordering value for a constraint.
     // Original test: -(zkj+zji') >= cik => outside
     // which translates to zij-zkj >= cik
@@ -242,27 +235,35 @@ namespace dbm
 
         return dbmij - dbm1[idim + j];
     }
-#endif
 
     // Subtraction itself using constraints in the minimal graph (bits) only.
-    // Return fdbm1 - dbm2, reading fdbm1 as one DBM and not a list.
-    static dbmlist_t internSubtract(fdbm_t* fdbm1, const raw_t* dbm2, cindex_t dim, const uint32_t* bits,
-                                    size_t bitsSize, size_t nbConstraints)
-    {
+    // Write the pieces of dbm1 - dbm2 to 'out', which owns dbm1:
+    // - out.getMatrix() returns dbm1 to read it
+    // - out.getCopy() returns dbm1 to write the remainder
+    // - out.split(dbm, dim) adds a copy of dbm as a piece and returns it
+    // - out.keep() adds the remainder as the last piece
+    // - out.drop() is called when the remainder is empty
+    // - out.count() counts a split.
+    // The strategy chooses the next constraint to split on. If the result
+    // is not disjoint then the remainder is not tightened by the splits.
+    template <typename Pieces>
+    static void subtractPieces(Pieces& out, const raw_t* dbm2, cindex_t dim, const uint32_t* bits, size_t bitsSize,
+                               size_t nbConstraints, fed_t::subtraction_t strategy, bool disjoint)
+    {
+        assert(strategy != fed_t::SUBTRACT_ADAPTIVE);
         assert(dim > 1);
         assertx(dbm_isValid(dbm2, dim));
-        assert(bits && fdbm1 && dbm2);
+        assert(bits && dbm2);
         assert(base_countBitsN(bits, bitsSize) == nbConstraints);
 
         std::vector<uint32_t> indices(nbConstraints);
-        raw_t* dbm1 = fdbm1->getMatrix();
-        dbmlist_t result;
+        raw_t* dbm1 = out.getMatrix();
         bool isMutable = false;
         uint32_t i = 0, j = 0, c = 0;
         auto k = static_cast<uint32_t>(nbConstraints);
 
         if (nbConstraints == 0)
-            return result;
+            return;
 
         // Write all the indices once since we will use them several times
         // but choose only those that have some effect on the subtraction.
@@ -300,7 +301,8 @@ namespace dbm
                 // If dbm2 outside dbm1 then no more subtraction.
                 assert(dbm2[ci * dim + cj] != dbm_LS_INFINITY);  // because part of mingraph
                 if (dbm_negRaw(dbm2[ci * dim + cj]) >= dbm1[cj * dim + ci]) {
-                    return result.append(fdbm1);
+                    out.keep();
+                    return;
                 }
                 if (dbm2[ci * dim + cj] >= dbm1[ci * dim + cj]) {
                     if (--nbConstraints == 0)
@@ -310,7 +312,14 @@ namespace dbm
                     continue;
                 }
                 // need to recompute everytime because dbm1 changes
-                if (bestv > -dbm_LS_INFINITY) {
+                if (strategy == fed_t::SUBTRACT_MINGRAPH) {
+                    if (bestv == INT_MAX) {  // first one
+                        bestv = 0;
+                        i = ci;
+                        j = cj;
+                        c = k;
+                    }
+                } else if (bestv > -dbm_LS_INFINITY) {
                     if (dbm1[ci * dim + cj] == dbm_LS_INFINITY) {
                         bestv = -dbm_LS_INFINITY;
                         i = ci;
@@ -319,13 +328,8 @@ namespace dbm
                         // Don't break the loop since the 1st test may
                         // cancel the split.
                     } else {
-#if SUBTRACTION_ALGORITHM == 2
-                        int32_t cv = dbm2[ci * dim + cj] - dbm1[ci * dim + cj];
-#elif SUBTRACTION_ALGORITHM == 3
-                        int32_t cv = worstValue(dbm1, dbm2, dim, ci, cj);
-#else
-#error "Invalid algorithm."
-#endif
+                        int32_t cv = strategy == fed_t::SUBTRACT_TIGHTEST ? dbm2[ci * dim + cj] - dbm1[ci * dim + cj]
+                                                                         : worstValue(dbm1, dbm2, dim, ci, cj);
                         if (bestv > cv) {
                             bestv = cv;
                             i = ci;
@@ -338,8 +342,10 @@ namespace dbm
             } while (k < nbConstraints);
 
             assert(c != (uint32_t)~0 && c < nbConstraints);  // found one index
-            assert(bestv != dbm_LS_INFINITY);                // found one index
-            indices[c] = indices[--nbConstraints];           // Swap with last
+            // The remainder is not tightened if not disjoint, so all
+            // the constraints may look outside.
+            assert(bestv != dbm_LS_INFINITY || !disjoint);
+            indices[c] = indices[--nbConstraints];  // Swap with last
 
             assert(i != j && i < dim && j < dim);
             assert(dbm2[i * dim + j] != dbm_LS_INFINITY);
@@ -350,108 +356,165 @@ namespace dbm
                 assert(negConstraint < dbm1[j * dim + i]);  // checked before
                 if (nbConstraints == 0)                     // is last constraint?
                 {
-                    dbm_tighten(isMutable ? dbm1 : fdbm1->dbmt().getCopy(), dim, j, i, negConstraint);
-                    INC();
-                    return result.append(fdbm1);
+                    dbm_tighten(isMutable ? dbm1 : out.getCopy(), dim, j, i, negConstraint);
+                    out.count();
+                    out.keep();
+                    return;
                 }
-                dbm_tighten(result.append(dbm1, dim), dim, j, i, negConstraint);
-                INC();
-#ifndef NDISJOINT_SUBTRACTION
-                if (!isMutable) {
-                    dbm1 = fdbm1->dbmt().getCopy();
-                    isMutable = true;
+                dbm_tighten(out.split(dbm1, dim), dim, j, i, negConstraint);
+                out.count();
+                if (disjoint) {
+                    if (!isMutable) {
+                        dbm1 = out.getCopy();
+                        isMutable = true;
+                    }
+                    dbm_tighten(dbm1, dim, i, j, dbm2[i * dim + j]);  // remainder
                 }
-                dbm_tighten(dbm1, dim, i, j, dbm2[i * dim + j]);  // remainder
-#else
-#warning "Subtraction: Result not disjoint."
-#endif
             }
         } while (nbConstraints != 0);
 
         /************** Deallocate remainder left and return result ****************/
     finish_subtract:
-        fdbm1->dbmt().nil();
-        fdbm1->remove();
-        return result;
+        out.drop();
     }
 
-#elif SUBTRACTION_ALGORITHM == 0
-#warning "Bad subtraction: Minimal graph only."
+    // Pieces of fdbm1 - dbm2 as a list that reuses fdbm1 for the remainder.
+    struct fdbm_pieces_t
+    {
+        fdbm_t* fdbm;
+        dbmlist_t result;
+        size_t nbSplits;
+
+        raw_t* getMatrix() { return fdbm->getMatrix(); }
+        raw_t* getCopy() { return fdbm->dbmt().getCopy(); }
+        raw_t* split(const raw_t* dbm, cindex_t dim) { return result.append(dbm, dim); }
+        void keep() { result.append(fdbm); }
+        void drop()
+        {
+            fdbm->dbmt().nil();
+            fdbm->remove();
+        }
+        void count()
+        {
+            INC();
+            nbSplits++;
+        }
+    };
 
-    // Subtraction itself using constraints in the minimal graph (bits) only.
     // Return fdbm1 - dbm2, reading fdbm1 as one DBM and not a list.
+    // The strategy is chosen once per subtracted DBM dbm2 by the caller.
     static dbmlist_t internSubtract(fdbm_t* fdbm1, const raw_t* dbm2, cindex_t dim, const uint32_t* bits,
-                                    size_t bitsSize, size_t nbConstraints)
+                                    size_t bitsSize, size_t nbConstraints, fed_t::subtraction_t strategy,
+                                    bool disjoint)
     {
-        assert(dim > 1);
-        assertx(dbm_isValid(dbm2, dim));
-        assert(nbConstraints && bits && fdbm1 && dbm2);
-        assert(base_countBitsN(bits, bitsSize) == nbConstraints);
-
-        dbmlist_t result;
-        raw_t* dbm1 = fdbm1->getMatrix();
-        bool isMutable = false;
-        uint32_t i = 0, j = 0, c = 0;
-        bool hasMore = true;
+        assert(fdbm1);
+        fdbm_pieces_t out{fdbm1, {}, 0};
+        subtractPieces(out, dbm2, dim, bits, bitsSize, nbConstraints, strategy, disjoint);
+        fed_recordSubtraction(strategy, dim, nbConstraints, out.nbSplits, out.result.size());
+        return out.result;
+    }
 
-        do {
-            /*********************** find constraint i,j to subtract ***************/
-            uint32_t count = 32;
-            for (uint32_t b = *bits++; b != 0; --count, ++j, b >>= 1) {
-                for (; (b & 1) == 0; --count, ++j, b >>= 1)  // look for a bit
-                {
-                    assert(count && b);
-                }
-                FIX_IJ();
-                hasMore = ++c < nbConstraints;
+    // Same for one DBM fdbm1.
+    static dbmlist_t internSubtract(fdbm_t* fdbm1, const raw_t* dbm2, cindex_t dim, const uint32_t* bits,
+                                    size_t bitsSize, size_t nbConstraints, bool disjoint)
+    {
+        return internSubtract(fdbm1, dbm2, dim, bits, bitsSize, nbConstraints,
+                              fed_chooseSubtraction(dim, nbConstraints), disjoint);
+    }
 
-                assert(i != j && i < dim && j < dim);
-                assert(dbm2[i * dim + j] != dbm_LS_INFINITY);  // in the minimal graph
+    // Pieces of dbm - dbm2 as raw DBMs, computed by a thread of the pool:
+    // nothing here touches the allocators or the DBM table.
+    struct raw_pieces_t
+    {
+        enum remainder_t { DROPPED, KEPT, TIGHTENED };
 
-                /******************* Subtraction for dbm2[i,j] *********************/
-                if (dbm2[i * dim + j] < dbm1[i * dim + j]) {
-                    raw_t negConstraint = dbm_negRaw(dbm2[i * dim + j]);
-                    if (negConstraint < dbm1[j * dim + i]) {
-                        if (!hasMore)  // is last constraint?
-                        {
-                            dbm_tighten(isMutable ? dbm1 : fdbm1->dbmt().getCopy(), dim, j, i, negConstraint);
-                            INC();
-                            return result.append(fdbm1);
-                        }
-                        dbm_tighten(result.append(dbm1, dim), dim, j, i, negConstraint);
-                        INC();
-#ifndef NDISJOINT_SUBTRACTION
-                        if (!isMutable) {
-                            dbm1 = fdbm1->dbmt().getCopy();
-                            isMutable = true;
-                        }
-                        dbm_tighten(dbm1, dim, i, j, dbm2[i * dim + j]);  // remainder
-#else
-#warning "Subtraction: Result not disjoint."
-#endif
-                    } else {
-                        // dbm2[i,j] < dbm1[i,j] => dbm2 tightens dbm1
-                        // -dbm2[i,j] >= dbm1[j,i] => substraction == remainder
-                        return result.append(fdbm1);
-                    }
-                }
+        const raw_t* dbm;            //< DBM to subtract from
+        cindex_t dim;                //< its dimension
+        bool intersects;             //< dbm intersects dbm2
+        remainder_t remainder;       //< what happens to dbm
+        size_t nbSplits;             //< for statistics
+        std::vector<raw_t> pieces;   //< all the pieces but the remainder
+        std::vector<raw_t> copy;     //< the remainder if TIGHTENED
 
-                /******************* Finish to read constraints i,j ****************/
-                assert(count);
+        raw_t* getMatrix() { return const_cast<raw_t*>(dbm); }  // read only
+        raw_t* getCopy()
+        {
+            copy.assign(dbm, dbm + dim * dim);
+            return copy.data();
+        }
+        raw_t* split(const raw_t* piece, cindex_t)
+        {
+            pieces.insert(pieces.end(), piece, piece + dim * dim);
+            return pieces.data() + pieces.size() - dim * dim;
+        }
+        void keep() { remainder = copy.empty() ? KEPT : TIGHTENED; }
+        void drop() { remainder = DROPPED; }
+        void count() { nbSplits++; }
+    };
+
+    // Return fdbms - dbm2 in the same order as the sequential loop
+    // of fed_t::ptr_subtract: the pieces are computed in parallel and
+    // the lists are built and merged by the calling thread afterwards.
+    static dbmlist_t parallelSubtract(fdbm_t* first, size_t size, const raw_t* dbm2, cindex_t dim,
+                                      const uint32_t* bits, size_t bitsSize, size_t nbConstraints, bool disjoint)
+    {
+        assert(subtraction_pool && dim > 1);
+
+        // The list is relinked while merging, so remember it first.
+        auto fdbms = std::vector<fdbm_t*>(size);
+        auto tasks = std::vector<raw_pieces_t>(size);
+        for (size_t k = 0; k < size; ++k, first = first->getNext()) {
+            assert(first);
+            fdbms[k] = first;
+            tasks[k].dbm = fdbms[k]->dbmt().const_dbm();
+            tasks[k].dim = dim;
+            tasks[k].remainder = raw_pieces_t::KEPT;
+            tasks[k].nbSplits = 0;
+        }
+        // One strategy per subtracted DBM, as in fed_t::ptr_subtract, so
+        // that the adaptive strategy gives the same result.
+        fed_t::subtraction_t strategy = fed_chooseSubtraction(dim, nbConstraints);
+        subtraction_pool->run(tasks.size(), [&](size_t k) {
+            raw_pieces_t& task = tasks[k];
+            // Real test would be to compute the intersection and check
+            // it's not empty but that costs dim^3.
+            task.intersects = dbm_haveIntersection(task.dbm, dbm2, dim);
+            if (task.intersects) {
+                task.remainder = raw_pieces_t::DROPPED;
+                subtractPieces(task, dbm2, dim, bits, bitsSize, nbConstraints, strategy, disjoint);
             }
-            j += count;  // unread bits
-        } while (hasMore);
+        });
 
-        /************** Deallocate remainder left and return result ****************/
-        fdbm1->dbmt().nil();
-        fdbm1->remove();
+        dbmlist_t result;
+        size_t dim2 = dim * dim;
+        for (size_t k = 0; k < fdbms.size(); ++k) {
+            raw_pieces_t& task = tasks[k];
+            if (!task.intersects) {
+                result.append(fdbms[k]);
+                continue;
+            }
+            dbmlist_t partial;
+            for (size_t n = 0; n < task.pieces.size(); n += dim2) {
+                partial.append(&task.pieces[n], dim);
+            }
+            if (task.remainder == raw_pieces_t::KEPT) {
+                partial.append(fdbms[k]);
+            } else {
+                if (task.remainder == raw_pieces_t::TIGHTENED) {
+                    partial.append(task.copy.data(), dim);
+                }
+                fdbms[k]->dbmt().nil();
+                fdbms[k]->remove();
+            }
+            fed_recordSubtraction(strategy, dim, nbConstraints, task.nbSplits, partial.size());
+            for (; task.nbSplits != 0; --task.nbSplits) {
+                INC();
+            }
+            result.unionWith(partial);
+        }
         return result;
     }
 
-#else
-#error "Invalid algorithm."
-#endif
-
     /***************
      * fdbm_t
      ***************/
@@ -504,12 +567,18 @@ namespace dbm
     void dbmlist_t::removeIncluded(dbmlist_t& arg)
     {
         RECORD_STAT();
+        if (fedSize >= UNION_INDEX_MIN && arg.fedSize >= UNION_INDEX_MIN && fhead->const_dbmt().pdim() > 1) {
+            removeIncludedIndexed(arg, fhead->const_dbmt().pdim());
+            return;
+        }
         for (fdbm_t** i = &fhead; *i != nullptr;) {
             fdbm_t** j = &arg.fhead;
             if (*j == nullptr)
                 break;  // stop all
             do {
-                switch ((*i)->const_dbmt().relation((*j)->const_dbmt())) {
+                const dbm_t& dbmi = (*i)->const_dbmt();
+                const dbm_t& dbmj = (*j)->const_dbmt();
+                switch (dbmi.hasDisjointBounds(dbmj) ? base_DIFFERENT : dbmi.relation(dbmj)) {
                 case base_EQUAL:
                 case base_SUBSET:  // remove from i (this)
                     RECORD_SUBSTAT("<=");
@@ -530,32 +599,149 @@ namespace dbm
         }
     }
 
-    void dbmlist_t::reduce(cindex_t dim)
+    // Exact duplicates are found by their hash values and the
+    // inclusions are checked only with the DBMs of this list whose
+    // bounds intersect, so that large unions are roughly linear.
+    // A duplicate of a DBM of this list or of a DBM of arg kept so
+    // far is removed from arg, after the DBMs of this list included
+    // in it are removed.
+    void dbmlist_t::removeIncludedIndexed(dbmlist_t& arg, cindex_t dim)
+    {
+        FedIndex index(fhead, fedSize, dim);
+        // Positions < fedSize are in this list, the others in kept.
+        std::unordered_multimap<uint32_t, size_t> hashes(fedSize + arg.fedSize);
+        std::vector<const dbm_t*> kept;
+        for (size_t k = 0; k < fedSize; ++k) {
+            hashes.emplace(index.getDBM(k).hash(), k);
+        }
+        std::vector<bool> removed(fedSize);
+        auto getDBM = [&](size_t k) -> const dbm_t& { return k < fedSize ? index.getDBM(k) : *kept[k - fedSize]; };
+
+        for (fdbm_t** j = &arg.fhead; *j != nullptr;) {
+            const dbm_t& dbmj = (*j)->const_dbmt();
+            uint32_t hashj = dbmj.hash();
+            auto range = hashes.equal_range(hashj);
+            auto same = std::find_if(range.first, range.second, [&](const std::pair<const uint32_t, size_t>& e) {
+                return (e.second >= fedSize || !removed[e.second]) && getDBM(e.second) == dbmj;
+            });
+            size_t duplicate = same == range.second ? SIZE_MAX : same->second;
+            bool included = duplicate != SIZE_MAX;
+            if (duplicate < fedSize || duplicate == SIZE_MAX) {
+                const raw_t* rawj = dbmj.const_dbm();
+                included |= index.search(
+                    [&](const raw_t* upper, const raw_t* lower) { return FedIndex::disjoint(upper, lower, rawj, dim); },
+                    [&](size_t k, const dbm_t& dbmi) {
+                        if (!removed[k] && k != duplicate) {
+                            switch (dbmi.relation(dbmj)) {
+                            case base_EQUAL:
+                            case base_SUBSET:  // remove from this
+                                RECORD_SUBSTAT("<=");
+                                removed[k] = true;
+                                break;
+                            case base_SUPERSET:  // remove from arg
+                                return duplicate == SIZE_MAX;
+                            case base_DIFFERENT: break;
+                            }
+                        }
+                        return false;
+                    });
+            }
+            if (included) {
+                RECORD_SUBSTAT(duplicate == SIZE_MAX ? ">" : "==");
+                *j = (*j)->removeAndNext();
+                arg.decSize();
+            } else {
+                hashes.emplace(hashj, fedSize + kept.size());
+                kept.push_back(&dbmj);
+                j = (*j)->getNextMutable();
+            }
+        }
+
+        size_t k = 0;
+        for (fdbm_t** i = &fhead; *i != nullptr; ++k) {
+            if (removed[k]) {
+                *i = (*i)->removeAndNext();
+                decSize();
+            } else {
+                i = (*i)->getNextMutable();
+            }
+        }
+    }
+
+    // A DBM is removed iff it is strictly included in another DBM or
+    // equal to an earlier one, which keeps one DBM of each maximal
+    // zone whatever the order of the visits.
+    void dbmlist_t::reduceIndexed(cindex_t dim)
+    {
+        FedIndex index(fhead, fedSize, dim);
+        std::vector<bool> removed(fedSize);
+        for (size_t j = 0; j < fedSize; ++j) {
+            const dbm_t& dbmj = index.getDBM(j);
+            const raw_t* rawj = dbmj.const_dbm();
+            removed[j] = index.search(
+                [&](const raw_t* upper, const raw_t* lower) { return FedIndex::disjoint(upper, lower, rawj, dim); },
+                [&](size_t k, const dbm_t& dbmk) {
+                    if (k == j) {
+                        return false;
+                    }
+                    relation_t rel = dbmk.relation(dbmj);
+                    return rel == base_SUPERSET || (rel == base_EQUAL && k < j);
+                });
+        }
+
+        size_t k = 0;
+        for (fdbm_t** i = &fhead; *i != nullptr; ++k) {
+            if (removed[k]) {
+                RECORD_SUBSTAT("<=");
+                *i = (*i)->removeAndNext();
+                decSize();
+            } else {
+                i = (*i)->getNextMutable();
+            }
+        }
+    }
+
+    void dbmlist_t::reduce(cindex_t dim, size_t jumpi)
     {
         if (size() > 1) {
             RECORD_STAT();
             fdbm_t** head = &fhead;
-            for (fdbm_t** fi = head; *fi != nullptr;) {
-                const raw_t* dbmi = (*fi)->const_dbmt().const_dbm();
-                for (fdbm_t** fj = (*fi)->getNextMutable(); *fj != nullptr;) {
-                    switch (dbm_relation(dbmi, (*fj)->const_dbmt().const_dbm(), dim)) {
+
+            // Jump already reduced head.
+            fdbm_t** fi;
+            for (fi = head; jumpi != 0; --jumpi) {
+                if (*fi == nullptr)
+                    return;
+                fi = (*fi)->getNextMutable();
+            }
+
+            // Compare the others with all the DBMs before them.
+            for (; *fi != nullptr;) {
+                const dbm_t& dbmi = (*fi)->const_dbmt();
+                for (fdbm_t** fj = head; fj != fi;) {
+                    const dbm_t& dbmj = (*fj)->const_dbmt();
+                    switch (dbmi.hasDisjointBounds(dbmj) ? base_DIFFERENT
+                                                         : dbm_relation(dbmi.const_dbm(), dbmj.const_dbm(), dim)) {
                     case base_DIFFERENT:
                         // next j
                         fj = (*fj)->getNextMutable();
                         break;
-                    case base_SUPERSET:
+                    case base_SUBSET:
                     case base_EQUAL:
                         RECORD_SUBSTAT("<=");
-                        // remove j
-                        *fj = (*fj)->removeAndNext();
-                        decSize();
-                        break;
-                    case base_SUBSET:
-                        RECORD_SUBSTAT("<");
                         // remove i
                         *fi = (*fi)->removeAndNext();
                         decSize();
                         goto reduce_abortj;
+                    case base_SUPERSET:
+                        RECORD_SUBSTAT(">");
+                        // remove j
+                        if ((*fj)->hasNext(fi)) {
+                            fi = fj;  // otherwise segfault when reading *fi
+                        }
+                        *fj = (*fj)->removeAndNext();
+                        decSize();
+                        break;
                     }
                 }
                 fi = (*fi)->getNextMutable();
@@ -570,9 +756,113 @@ namespace dbm
     {
         return (cij != dbm_LS_INFINITY && cji != dbm_LS_INFINITY && (cij + cji - (cij & cji & 1)) < dbm_LE_ZERO);
     }
+
+    // fed_checkWeakAdd on the bounds of the clocks only, to skip
+    // pairs of DBMs before reading their matrices.
+    static inline bool fed_checkWeakBounds(const dbm_t& dbm1, const dbm_t& dbm2, cindex_t dim)
+    {
+        const raw_t* upper1 = dbm1.getUpperBounds();
+        const raw_t* upper2 = dbm2.getUpperBounds();
+        const raw_t* lower1 = dbm1.const_dbm();
+        const raw_t* lower2 = dbm2.const_dbm();
+        for (cindex_t i = 1; i < dim; ++i) {
+            if (fed_checkWeakAdd(upper1[i], lower2[i]) || fed_checkWeakAdd(lower1[i], upper2[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
 #endif
 
-    void dbmlist_t::mergeReduce(cindex_t dim, size_t jumpi, int level)
+    // No intersection for sure between the constraint cij of
+    // a DBM and cji of another one, computed without branches.
+    static inline bool fed_noIntersection(raw_t cij, raw_t cji)
+    {
+        bool finite = (cij != dbm_LS_INFINITY) & (cji != dbm_LS_INFINITY);
+#ifdef IMPROVED_MERGE
+        // fed_checkWeakAdd, wrapping instead of overflowing on infinity
+        return finite & ((raw_t)((uint32_t)cij + (uint32_t)cji - (uint32_t)(cij & cji & 1)) < dbm_LE_ZERO);
+#else
+        return finite & (dbm_negRaw(dbm_weakRaw(cij)) >= dbm_weakRaw(cji));
+#endif
+    }
+
+    // Relation between 2 DBMs and whether they have some
+    // constraint in common, for mergeReduce and convexReduce.
+    struct fed_pair_t
+    {
+        bool disjoint;    //< no intersection for sure, the rest is not computed
+        bool subset;      //< dbm1 <= dbm2
+        bool superset;    //< dbm1 >= dbm2
+        bool compatible;  //< some constraint is the same
+    };
+
+    // The DBM compared to the others in mergeReduce and convexReduce,
+    // with its transpose so that the disjointness test of cij against
+    // cji reads the matrices in memory order like the other tests. The
+    // comparison is then one flat pass without branches, which the
+    // compiler vectorizes, instead of a strided and branching one.
+    class fed_pivot_t
+    {
+    public:
+        explicit fed_pivot_t(cindex_t d): dim(d), transposed(d * d) {}
+
+        // Compare from now on dbm (dbm1) to the others (dbm2).
+        void set(const raw_t* dbm)
+        {
+            pivot = dbm;
+            for (cindex_t i = 0; i < dim; ++i) {
+                for (cindex_t j = 0; j < dim; ++j) {
+                    transposed[i * dim + j] = dbm[j * dim + i];
+                }
+                transposed[i * dim + i] = dbm_LS_INFINITY;  // the diagonal is not a constraint
+            }
+        }
+
+        fed_pair_t compare(const raw_t* dbm) const
+        {
+            const raw_t* transpose = transposed.data();
+            uint32_t disjoint = 0, notSubset = 0, notSuperset = 0, same = 0;
+            for (uint32_t k = 0, n = dim * dim; k < n; ++k) {
+                disjoint |= fed_noIntersection(transpose[k], dbm[k]);
+                notSubset |= pivot[k] > dbm[k];
+                notSuperset |= pivot[k] < dbm[k];
+                same += pivot[k] == dbm[k];
+            }
+            // The diagonals are the same.
+            return {disjoint != 0, notSubset == 0, notSuperset == 0, dim <= 2 || same > dim};
+        }
+
+    private:
+        cindex_t dim;
+        const raw_t* pivot = nullptr;
+        std::vector<raw_t> transposed;
+    };
+
+    // Number of clocks i > 0 for which both cij and cji are the same
+    // in 2 DBMs for some j < i. Only needed when merging is tried.
+    static inline cindex_t fed_compatibleRows(const raw_t* dbm1, const raw_t* dbm2, cindex_t dim)
+    {
+        cindex_t nb = 0;
+        for (cindex_t i = 1; i < dim; ++i) {
+            bool sameRow = false;
+            for (cindex_t j = 0; j < i; ++j) {
+                sameRow |= (dbm1[i * dim + j] == dbm2[i * dim + j]) & (dbm1[j * dim + i] == dbm2[j * dim + i]);
+            }
+            nb += sameRow ? 1 : 0;
+        }
+        return nb;
+    }
+
+    // mergeReduce tries to merge 2 DBMs only if enough clocks
+    // have the same constraints cij and cji for some j.
+    static inline bool fed_isMergeCandidate(const raw_t* dbm1, const raw_t* dbm2, cindex_t dim, int level)
+    {
+        cindex_t nbOK = (dim <= 2 ? 1 : 0) + fed_compatibleRows(dbm1, dbm2, dim);
+        return (level != 0 || !restricted_merge) ? nbOK > 0 : nbOK + 2 >= dim;
+    }
+
+    void dbmlist_t::mergeReduce(cindex_t dim, size_t jumpi, int level, budget_t* budget)
     {
         // at least 2 DBMs
         if (size() > 1) {
@@ -589,53 +879,36 @@ namespace dbm
             }
 
             // Continue.
+            fed_pivot_t pivot(dim);
             for (; *fi != nullptr;) {
                 const dbm_t& dbmi = (*fi)->const_dbmt();
+                pivot.set(dbmi.const_dbm());
                 for (fdbm_t** fj = head; fj != fi;) {
+                    if (budget != nullptr && !budget->spend()) {
+                        return;  // the list is consistent
+                    }
                     const dbm_t& dbmj = (*fj)->const_dbmt();
                     const raw_t* dbm1 = dbmi.const_dbm();
                     const raw_t* dbm2 = dbmj.const_dbm();
-                    cindex_t nbOK = (dim <= 2) ? 1 : 0;
-                    bool superset = true, subset = true;
-
-                    for (cindex_t i = 1; i < dim; ++i) {
-                        bool constraintsOK = false;
-                        for (cindex_t j = 0; j < i; ++j) {
-                            uint32_t ij = i * dim + j;
-                            uint32_t ji = j * dim + i;
+                    fed_pair_t pair;
 
-                            // No intersection for sure
 #ifdef IMPROVED_MERGE
-                            if (fed_checkWeakAdd(dbm1[ij], dbm2[ji]) || fed_checkWeakAdd(dbm1[ji], dbm2[ij]))
-#else
-                            if ((dbm1[ij] != dbm_LS_INFINITY && dbm2[ji] != dbm_LS_INFINITY &&
-                                 dbm_negRaw(dbm_weakRaw(dbm1[ij])) >= dbm_weakRaw(dbm2[ji])) ||
-                                (dbm1[ji] != dbm_LS_INFINITY && dbm2[ij] != dbm_LS_INFINITY &&
-                                 dbm_negRaw(dbm_weakRaw(dbm1[ji])) >= dbm_weakRaw(dbm2[ij])))
+                    if (fed_checkWeakBounds(dbmi, dbmj, dim)) {
+                        RECORD_SUBSTAT("skip");
+                        goto next_fj;
+                    }
 #endif
-                            {
-                                goto next_fj;
-                            }
-
-                            // Relation by the way :)
-                            subset &= (dbm1[ij] <= dbm2[ij]);
-                            superset &= (dbm1[ij] >= dbm2[ij]);
-                            subset &= (dbm1[ji] <= dbm2[ji]);
-                            superset &= (dbm1[ji] >= dbm2[ji]);
-
-                            // Compatible constraints
-                            constraintsOK |= ((dbm1[ij] == dbm2[ij]) &&  // | possible
-                                              (dbm1[ji] == dbm2[ji]));
-                        }
-                        nbOK += constraintsOK ? 1 : 0;
+                    pair = pivot.compare(dbm2);
+                    if (pair.disjoint) {
+                        goto next_fj;
                     }
-                    if (subset)  // remove dbmi
+                    if (pair.subset)  // remove dbmi
                     {
                         RECORD_SUBSTAT("<=");
                         *fi = (*fi)->removeAndNext();
                         decSize();
                         goto continue_fi;
-                    } else if (superset)  // remove dbmj
+                    } else if (pair.superset)  // remove dbmj
                     {
                         RECORD_SUBSTAT(">=");
                         if ((*fj)->hasNext(fi)) {
@@ -644,7 +917,7 @@ namespace dbm
                         *fj = (*fj)->removeAndNext();
                         decSize();
                         continue;
-                    } else if ((level != 0 || !restricted_merge) ? nbOK > 0 : nbOK + 2 >= dim) {
+                    } else if (pair.compatible && fed_isMergeCandidate(dbm1, dbm2, dim, level)) {
                         RECORD_SUBSTAT("mergeable");
                         dbm_t convex = dbmi;
                         convex += dbmj;
@@ -660,6 +933,9 @@ namespace dbm
                             if (level == 1) {
                                 // See if (convex union)-(dbmi|dbmj) is included somewhere.
                                 for (fdbm_t** fk = head; *fk != nullptr; fk = (*fk)->getNextMutable()) {
+                                    if (budget != nullptr && !budget->spend()) {
+                                        break;  // not merged
+                                    }
                                     if (fk != fi && fk != fj) {
                                         fc.removeIncludedIn((*fk)->const_dbmt());
                                         if (fc.isEmpty()) {
@@ -672,6 +948,9 @@ namespace dbm
                                 // Remove incrementally DBMs from (convex union)-(dbmi|dbmj)
                                 // and check if the remaining becomes empty.
                                 for (fdbm_t** fk = head; *fk != nullptr; fk = (*fk)->getNextMutable()) {
+                                    if (budget != nullptr && !budget->spend(fc.size())) {
+                                        break;  // not merged
+                                    }
                                     if (fk != fi && fk != fj && (fc -= (*fk)->const_dbmt()).isEmpty()) {
                                         safeMerge = true;
                                         break;
@@ -684,6 +963,7 @@ namespace dbm
                         if (safeMerge) {
                             RECORD_SUBSTAT("merged");
                             (*fi)->dbmt().updateCopy(convex);
+                            pivot.set(dbmi.const_dbm());
                             if ((*fj)->hasNext(fi)) {
                                 fi = fj;  // otherwise segfault when reading *fi
                             }
@@ -781,19 +1061,60 @@ namespace dbm
         ifed->fedSize = size;
         ifed->dim = dim;
         ifed->fhead = head;
+        ifed->index = nullptr;
+        ifed->interned = false;
+        ifed->resetReduced();
         return ifed;
     }
 
     void ifed_t::remove()
     {
         assert(refCounter == 0);
+        dropIndex();
+        unintern();
         fdbm_t::removeAll(fhead);
         ifed_allocator.deallocate(reinterpret_cast<alloc_ifed_t*>(this));
     }
 
+    const FedIndex* ifed_t::getIndex(size_t minSize) const
+    {
+        if (fedSize < minSize || dim <= 1) {
+            return nullptr;
+        }
+        if (index == nullptr) {
+            index = new FedIndex(fhead, fedSize, dim);
+        }
+        assert(index->isValid(fhead, fedSize));
+        return index;
+    }
+
+    void ifed_t::deleteIndex()
+    {
+        assert(index);
+        delete index;
+        index = nullptr;
+    }
+
+    void ifed_t::removeInterned()
+    {
+        assert(interned);
+        auto range = fed_table().equal_range(internHash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == this) {
+                fed_table().erase(it);
+                interned = false;
+                return;
+            }
+        }
+        assert(false);  // not found
+    }
+
     // compute a hash value from all its DBMs
     uint32_t ifed_t::hash(uint32_t seed) const
     {
+        if (interned && seed == 0) {
+            return internHash;
+        }
         // The problem is here to return the same hash for several
         // fed_t that have the same dbm_t in different order.
 
@@ -812,8 +1133,119 @@ namespace dbm
      * fed_t
      ***************/
 
+    // The DBMs already added by a bulk constructor, to skip
+    // the ones equal to another one.
+    class fed_unique_t
+    {
+    public:
+        fed_unique_t(cindex_t d, size_t count): dim(d), hashes(count) {}
+
+        bool isNew(const raw_t* dbm)
+        {
+            uint32_t hash = dbm_hash(dbm, dim);
+            auto range = hashes.equal_range(hash);
+            if (std::any_of(range.first, range.second, [&](const std::pair<const uint32_t, const raw_t*>& e) {
+                    return dbm_areEqual(e.second, dbm, dim);
+                })) {
+                return false;
+            }
+            hashes.emplace(hash, dbm);
+            return true;
+        }
+
+    private:
+        cindex_t dim;
+        std::unordered_multimap<uint32_t, const raw_t*> hashes;
+    };
+
+    // The list is built directly from the end (insert adds
+    // at the beginning), without the checks of add.
+    fed_t::fed_t(const raw_t* dbms, size_t count, cindex_t dim, bool unique, bool reduce):
+        ifedPtr(ifed_t::create(dim))
+    {
+        assert(dim >= 1);
+        size_t dim2 = dim * dim;
+        dbm_reserve(dim, count);
+        fed_unique_t seen(dim, unique ? count : 0);
+        for (size_t k = count; k-- > 0;) {
+            const raw_t* dbm = dbms + k * dim2;
+            assertx(dbm_isValid(dbm, dim));
+            if (!unique || seen.isNew(dbm)) {
+                ifedPtr->insert(dbm, dim);
+            }
+        }
+        if (reduce) {
+            this->reduce();
+        }
+    }
+
+    fed_t::fed_t(const dbm_t* dbms, size_t count, cindex_t dim, bool unique, bool reduce):
+        ifedPtr(ifed_t::create(dim))
+    {
+        assert(dim >= 1);
+        fed_unique_t seen(dim, unique ? count : 0);
+        for (size_t k = count; k-- > 0;) {
+            if (!dbms[k].isEmpty()) {
+                assert(dbms[k].getDimension() == dim);
+                if (!unique || seen.isNew(dbms[k].const_dbm())) {
+                    ifedPtr->insert(dbms[k]);
+                }
+            }
+        }
+        if (reduce) {
+            this->reduce();
+        }
+    }
+
     void fed_t::heuristicMergeReduce(bool active) { restricted_merge = active; }
 
+    void fed_t::parallelSubtraction(size_t nbThreads, size_t minSize)
+    {
+        subtraction_pool.reset(nbThreads > 1 ? new WorkPool(nbThreads) : nullptr);
+        subtraction_threshold = minSize;
+    }
+
+    void fed_t::parallelOperations(size_t nbThreads, size_t minSize)
+    {
+        operation_pool.reset(nbThreads > 1 ? new WorkPool(nbThreads) : nullptr);
+        operation_threshold = minSize;
+    }
+
+    void fed_t::predtCache(size_t nbEntries)
+    {
+        predt_memo_capacity = nbEntries;
+        while (predt_memo.size() > predt_memo_capacity) {
+            predt_evict();
+        }
+    }
+
+    void fed_t::spatialIndex(size_t minSize) { index_threshold = minSize; }
+
+    void fed_t::subtractionStrategy(subtraction_t strategy) { subtraction_strategy = strategy; }
+
+    fed_t::subtraction_stats_t fed_t::getSubtractionStats(subtraction_t strategy)
+    {
+        assert(strategy < SUBTRACT_ADAPTIVE);
+        subtraction_stats_t result{};
+        for (auto& dims : subtraction_stats) {
+            for (auto& stats : dims) {
+                result.calls += stats[strategy].calls;
+                result.splits += stats[strategy].splits;
+                result.pieces += stats[strategy].pieces;
+            }
+        }
+        return result;
+    }
+
+    void fed_t::resetSubtractionStats()
+    {
+        for (auto& dims : subtraction_stats) {
+            for (auto& stats : dims) {
+                std::fill(stats, stats + SUBTRACT_ADAPTIVE, subtraction_stats_t{});
+            }
+        }
+    }
+
     std::ostream& fed_t::print(std::ostream& os, const ClockAccessor& access, bool full) const
     {
         if (isEmpty())
@@ -842,6 +1274,18 @@ namespace dbm
         return std::find_if(begin(), end(), [](auto& i) { return i.canDelay(); }) != end();
     }
 
+    // The DBMs are interned first, then equal DBMs share their matrix.
+    static std::vector<const raw_t*> fed_sortedDBMs(const ifed_t* ifed)
+    {
+        std::vector<const raw_t*> dbms;
+        dbms.reserve(ifed->size());
+        for (const fdbm_t* fdbm = ifed->const_head(); fdbm != nullptr; fdbm = fdbm->getNext()) {
+            dbms.push_back(fdbm->const_dbmt().const_dbm());
+        }
+        std::sort(dbms.begin(), dbms.end());
+        return dbms;
+    }
+
     void fed_t::intern()
     {
         for (const auto& iter : *this) {
@@ -849,6 +1293,27 @@ namespace dbm
             // itself. This postpones copies of ifed_t and dbm_t.
             const_cast<dbm_t&>(iter).intern();
         }
+        if (ifedPtr->interned) {
+            return;
+        }
+        uint32_t hashValue = ifedPtr->hash();
+        auto range = fed_table().equal_range(hashValue);
+        if (range.first != range.second) {
+            std::vector<const raw_t*> dbms = fed_sortedDBMs(ifedPtr);
+            for (auto it = range.first; it != range.second; ++it) {
+                ifed_t* other = it->second;
+                if (other->getDimension() == getDimension() && other->size() == size() &&
+                    fed_sortedDBMs(other) == dbms) {
+                    other->incRef();
+                    decRef();
+                    ifedPtr = other;
+                    return;
+                }
+            }
+        }
+        ifedPtr->internHash = hashValue;
+        ifedPtr->interned = true;
+        fed_table().emplace(hashValue, ifedPtr);
     }
 
     void fed_t::setDimension(cindex_t dim)
@@ -1061,7 +1526,9 @@ namespace dbm
                 for (const_iterator jter = arg.begin(); j < argSize; ++j, ++jter) {
                     // if there is some information to gain
                     if ((base_sub2super((relation_t)crossRel[i]) & crossRel[j] & base_SUPERSET) == 0) {
-                        relation_t rel = dbm_relation(iter->const_dbm(), jter->const_dbm() /*argDBM[j]*/, dim);
+                        relation_t rel = iter->hasDisjointBounds(*jter)
+                                             ? base_DIFFERENT
+                                             : dbm_relation(iter->const_dbm(), jter->const_dbm() /*argDBM[j]*/, dim);
                         crossRel[i] |= rel & base_SUBSET;    // all of this <= some of arg
                         crossRel[j] |= rel & base_SUPERSET;  // all of arg <= some of this
                     }
@@ -1128,15 +1595,34 @@ namespace dbm
         assert(!isEmpty());
 
         if (size() == 1) {
-            return dbm_relation(const_dbmt().const_dbm(), arg, dim);
+            return const_dbmt().hasDisjointBounds(arg, dim) ? base_DIFFERENT
+                                                            : dbm_relation(const_dbmt().const_dbm(), arg, dim);
         } else {
             // subset: if subset for all DBMs => &=
             // superset: if superset for one DBM => |=
             uint32_t subset = base_SUBSET;
             uint32_t superset = 0;
 
+            if (const FedIndex* index = fed_getIndex(ifed())) {
+                // DBMs not visited are different from arg
+                size_t nb = 0;
+                index->search(
+                    [&](const raw_t* upper, const raw_t* lower) { return FedIndex::disjoint(upper, lower, arg, dim); },
+                    [&](size_t, const dbm_t& dbm) {
+                        relation_t rel = dbm_relation(dbm.const_dbm(), arg, dim);
+                        subset &= rel;
+                        superset |= rel & base_SUPERSET;
+                        ++nb;
+                        return subset == 0 && superset != 0;  // known
+                    });
+                if (nb < size()) {
+                    subset = 0;
+                }
+                return (relation_t)(subset | superset);
+            }
             for (const auto& iter : *this) {
-                relation_t rel = dbm_relation(iter.const_dbm(), arg, dim);
+                relation_t rel =
+                    iter.hasDisjointBounds(arg, dim) ? base_DIFFERENT : dbm_relation(iter.const_dbm(), arg, dim);
                 subset &= rel;
                 superset |= rel & base_SUPERSET;
             }
@@ -1153,6 +1639,9 @@ namespace dbm
 
         if (isEmpty()) {
             return false;
+        } else if (const FedIndex* index = fed_getIndex(ifed())) {
+            return fed_anyIntersecting(index, arg, dim,
+                                       [&](const dbm_t& dbm) { return dbm_isSupersetEq(dbm.const_dbm(), arg, dim); });
         } else {
             for (const auto& iter : *this) {
                 if (dbm_isSupersetEq(iter.const_dbm(), arg, dim)) {
@@ -1182,6 +1671,138 @@ namespace dbm
         }
     }
 
+    // Estimate of the part of the bounding box of dbm that is also in
+    // the bounding box of arg, between 0 and 1, strictness ignored.
+    static double fed_boxOverlap(const raw_t* dbm, const raw_t* upper, const raw_t* arg, const raw_t* argUpper,
+                                 cindex_t dim)
+    {
+        const double inf = HUGE_VAL;
+        double overlap = 1.0;
+        for (cindex_t i = 1; i < dim; ++i) {
+            double low = -dbm_raw2bound(dbm[i]);
+            double up = upper[i] == dbm_LS_INFINITY ? inf : dbm_raw2bound(upper[i]);
+            double lo = std::max(low, -(double)dbm_raw2bound(arg[i]));
+            double hi = std::min(up, argUpper[i] == dbm_LS_INFINITY ? inf : dbm_raw2bound(argUpper[i]));
+            if (up == inf) {
+                overlap *= hi == inf ? 1.0 : 0.5;
+            } else if (up > low) {
+                overlap *= std::max(0.0, hi - lo) / (up - low);
+            } else if (hi < lo) {
+                return 0.0;
+            }
+        }
+        return overlap;
+    }
+
+    // Exact inclusion of DBMs in a federation, one DBM at a time so
+    // that inclusion checks stop at the first DBM that is not included,
+    // without computing whole differences of federations. A DBM is
+    // first checked against the bounding box of the federation, then
+    // against its DBMs one by one, and only then the DBMs of the
+    // federation whose bounds intersect it are subtracted from it,
+    // the ones that cover most of it first, until nothing is left.
+    // This uses the upper bounds and the minimal graphs cached in
+    // the idbm_t of the federation.
+    class fed_cover_t
+    {
+    public:
+        fed_cover_t(const fed_t& f, const FedIndex* idx):
+            fed(f), index(idx), dim(f.getDimension()), box(2 * f.getDimension(), -dbm_LS_INFINITY)
+        {
+            for (const auto& dbm : fed) {
+                const raw_t* upper = dbm.getUpperBounds();
+                for (cindex_t i = 1; i < dim; ++i) {
+                    box[i] = std::max(box[i], dbm.const_dbm()[i]);
+                    box[dim + i] = std::max(box[dim + i], upper[i]);
+                }
+            }
+        }
+
+        /// @return true if dbm <= fed.
+        bool covers(const dbm_t& dbm)
+        {
+            if (fed.isEmpty()) {
+                return false;
+            } else if (dim <= 1) {
+                return true;
+            }
+            const raw_t* raw = dbm.const_dbm();
+            const raw_t* upper = dbm.getUpperBounds();
+            for (cindex_t i = 1; i < dim; ++i) {
+                if (raw[i] > box[i] || upper[i] > box[dim + i]) {
+                    return false;
+                }
+            }
+            candidates.clear();
+            auto coversAlone = [&](const dbm_t& arg) {
+                if (dbm_isSubsetEq(raw, arg.const_dbm(), dim)) {
+                    return true;
+                }
+                candidates.emplace_back(fed_boxOverlap(raw, upper, arg.const_dbm(), arg.getUpperBounds(), dim), &arg);
+                return false;
+            };
+            if (index != nullptr) {
+                if (fed_anyIntersecting(index, raw, dim, coversAlone)) {
+                    return true;
+                }
+            } else {
+                for (const auto& arg : fed) {
+                    if (!arg.hasDisjointBounds(dbm) && coversAlone(arg)) {
+                        return true;
+                    }
+                }
+            }
+            if (candidates.size() < 2) {
+                return false;  // dbm - one DBM that does not contain it is not empty
+            }
+            std::stable_sort(candidates.begin(), candidates.end(),
+                             [](const candidate_t& a, const candidate_t& b) { return a.first > b.first; });
+            fed_t left(dbm);
+            for (const auto& candidate : candidates) {
+                if ((left -= *candidate.second).isEmpty()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        using candidate_t = std::pair<double, const dbm_t*>;  //< overlap estimate, DBM
+
+        const fed_t& fed;
+        const FedIndex* index;
+        cindex_t dim;
+        std::vector<raw_t> box;  //< loosest lower bounds then upper bounds of fed
+        std::vector<candidate_t> candidates;
+    };
+
+    // All the DBMs of fed covered by cover, checked one at a time.
+    class fed_inclusion_t
+    {
+    public:
+        fed_inclusion_t(const fed_t& fed, const fed_t& arg, const FedIndex* argIndex):
+            cover(arg, argIndex), current(fed.begin()), end(fed.end())
+        {}
+
+        /// @return true while the inclusion is possible but not known.
+        bool isOpen() const { return included && current != end; }
+
+        /// @return false if fed is not included in arg.
+        bool isIncluded() const { return included; }
+
+        /// Check the next DBM, @pre isOpen().
+        void next()
+        {
+            included = cover.covers(*current);
+            ++current;
+        }
+
+    private:
+        fed_cover_t cover;
+        fed_t::const_iterator current, end;
+        bool included = true;
+    };
+
     // 1 - trivial cases like relation(),
     // 2 - try the "easy" relation(),
     // 3 - check for superset.
@@ -1195,8 +1816,23 @@ namespace dbm
         } else if (getDimension() != arg.getDimension()) {
             return base_DIFFERENT;
         } else {
-            auto thisIncluded = isSubtractionEmpty(arg) ? 1u : 0u;
-            auto argIncluded = arg.isSubtractionEmpty(*this) ? 1u : 0u;
+            // Both directions in turn, until both are known to fail or
+            // the ones that may succeed are done.
+            fed_inclusion_t thisIn(*this, arg, fed_getIndex(arg.ifed()));
+            fed_inclusion_t argIn(arg, *this, fed_getIndex(ifed()));
+            while (thisIn.isOpen() || argIn.isOpen()) {
+                if (thisIn.isOpen()) {
+                    thisIn.next();
+                }
+                if (argIn.isOpen()) {
+                    argIn.next();
+                }
+                if (!thisIn.isIncluded() && !argIn.isIncluded()) {
+                    return base_DIFFERENT;
+                }
+            }
+            auto thisIncluded = thisIn.isIncluded() ? 1u : 0u;
+            auto argIncluded = argIn.isIncluded() ? 1u : 0u;
 
             // Accumulate results
             static_assert(base_SUPERSET == 1 && base_SUBSET == 2);
@@ -1309,9 +1945,17 @@ namespace dbm
             assert(arg.getDimension() == getDimension());
             setMutable();
             cindex_t dim = getDimension();
-            for (const auto& iter : arg)
-                if (removeIncludedIn(iter.const_dbm(), dim))
-                    ifed()->insert(iter);
+            if (size() >= UNION_INDEX_MIN && arg.size() >= UNION_INDEX_MIN && dim > 1) {
+                // Reduced like the DBMs inserted one by one below.
+                dbmlist_t copy = arg.ifed()->copyList();
+                copy.reduceIndexed(dim);
+                ifed()->removeIncluded(copy);
+                ifed()->appendBegin(copy);
+            } else {
+                for (const auto& iter : arg)
+                    if (removeIncludedIn(iter.const_dbm(), dim))
+                        ifed()->insert(iter);
+            }
         }
         return *this;
     }
@@ -1403,10 +2047,16 @@ namespace dbm
         assert(arg.isOK());
 
         if (!arg.isEmpty()) {
+            // The DBMs at the beginning stay reduced.
+            const ifed_t* previous = ifedPtr;
+            ifed_t::reduced_t reduced = ifedPtr->getReduced();
             setMutable();
             arg.setMutable();
             ifed()->appendEnd(*arg.ifed());
             arg.ifed()->reset();
+            if (ifedPtr == previous) {
+                ifedPtr->restoreReduced(reduced);
+            }
         }
         return *this;
     }
@@ -1496,10 +2146,26 @@ namespace dbm
 
             // compute result = union_i(this & arg[i]) with arg[i] = ith DBM of arg.
             size_t s;
-            for (++i; i != e; ++i) {
-                // result.unionWith(ifed()->copyList().intersection(*i, dim));
-                s = result.size();
-                result.appendEnd(ifed()->copyList().intersection(*i, dim)).mergeReduce(dim, s);
+            const FedIndex* index = arg.size() > 1 ? fed_getIndex(static_cast<const fed_t*>(this)->ifed()) : nullptr;
+            if (index) {
+                // Copy only the DBMs that may intersect arg[i], in the
+                // order of copyList() (reversed), the others would give
+                // empty DBMs.
+                for (++i; i != e; ++i) {
+                    std::vector<size_t> candidates = index->overlapping(i->const_dbm());
+                    fdbm_t* head = nullptr;
+                    for (size_t k : candidates) {
+                        head = fdbm_t::create(index->getDBM(k), head);
+                    }
+                    s = result.size();
+                    result.appendEnd(dbmlist_t(candidates.size(), head).intersection(*i, dim)).mergeReduce(dim, s);
+                }
+            } else {
+                for (++i; i != e; ++i) {
+                    // result.unionWith(ifed()->copyList().intersection(*i, dim));
+                    s = result.size();
+                    result.appendEnd(ifed()->copyList().intersection(*i, dim)).mergeReduce(dim, s);
+                }
             }
             // ifed()->intersection(arg1, dim).unionWith(result);
             s = result.size();
@@ -1537,7 +2203,11 @@ namespace dbm
         return *this;
     }
 
-    fed_t& fed_t::operator-=(const fed_t& arg)
+    fed_t& fed_t::operator-=(const fed_t& arg) { return subtract(arg, disjoint_subtraction); }
+    fed_t& fed_t::operator-=(const dbm_t& arg) { return subtract(arg, disjoint_subtraction); }
+    fed_t& fed_t::operator-=(const raw_t* arg) { return subtract(arg, getDimension(), disjoint_subtraction); }
+
+    fed_t& fed_t::subtract(const fed_t& arg, bool disjoint)
     {
         assert(isOK());
         assert(arg.isOK());
@@ -1546,7 +2216,7 @@ namespace dbm
         if (sameAs(arg)) {
             setEmpty();
         } else if (arg.size() == 1) {
-            return *this -= arg.const_dbmt();
+            return subtract(arg.const_dbmt(), disjoint);
         } else if (!isEmpty() && !arg.isEmpty()) {
             setMutable();
 #ifndef ENABLE_STORE_MINGRAPH
@@ -1554,9 +2224,9 @@ namespace dbm
 #endif
             for (const auto& i : arg) {
 #ifdef ENABLE_STORE_MINGRAPH
-                ptr_subtract(i);
+                ptr_subtract(i, disjoint);
 #else
-                ptr_subtract(i->const_dbm(), dim);
+                ptr_subtract(i.const_dbm(), dim, disjoint);
 #endif
                 if (isEmpty())
                     break;
@@ -1565,7 +2235,7 @@ namespace dbm
         return *this;
     }
 
-    fed_t& fed_t::operator-=(const dbm_t& arg)
+    fed_t& fed_t::subtract(const dbm_t& arg, bool disjoint)
     {
         assert(isOK());
         assert(getDimension() == arg.getDimension());
@@ -1579,21 +2249,21 @@ namespace dbm
             } else {
                 setMutable();
 #ifdef ENABLE_STORE_MINGRAPH
-                ptr_subtract(arg);
+                ptr_subtract(arg, disjoint);
 #else
-                ptr_subtract(arg.const_dbm(), getDimension());
+                ptr_subtract(arg.const_dbm(), getDimension(), disjoint);
 #endif
             }
         }
         return *this;
     }
 
-    fed_t& fed_t::operator-=(const raw_t* arg)
+    fed_t& fed_t::subtract(const raw_t* arg, cindex_t dim, bool disjoint)
     {
         assert(isOK());
-        assertx(dbm_isValid(arg, getDimension()));
+        assert(dim == getDimension());
+        assertx(dbm_isValid(arg, dim));
 
-        cindex_t dim = getDimension();
         if (!isEmpty()) {
             RECORD_STAT();
             RECORD_SUBSTAT(getDimension() == 1 ? "dim==1" : (*this <= arg ? "*this<=arg" : "non-trivial"));
@@ -1602,7 +2272,7 @@ namespace dbm
                 setEmpty();
             } else {
                 setMutable();
-                ptr_subtract(arg, dim);
+                ptr_subtract(arg, dim, disjoint);
             }
         }
         return *this;
@@ -1622,9 +2292,9 @@ namespace dbm
             for (const auto& i : arg) {
                 if (!canSkipSubtract(i.const_dbm(), dim)) {
 #if ENABLE_STORE_MINGRAPH
-                    ptr_subtract(i);
+                    ptr_subtract(i, disjoint_subtraction);
 #else
-                    ptr_subtract(i.const_dbm(), dim);
+                    ptr_subtract(i.const_dbm(), dim, disjoint_subtraction);
 #endif
                     if (isEmpty())
                         return *this;
@@ -1647,9 +2317,9 @@ namespace dbm
             if (!canSkipSubtract(arg.const_dbm(), dim)) {
                 setMutable();
 #ifdef ENABLE_STORE_MINGRAPH
-                ptr_subtract(arg);
+                ptr_subtract(arg, disjoint_subtraction);
 #else
-                ptr_subtract(arg.const_dbm(), dim);
+                ptr_subtract(arg.const_dbm(), dim, disjoint_subtraction);
 #endif
             }
         }
@@ -1667,14 +2337,97 @@ namespace dbm
         cindex_t dim = getDimension();
         if (!canSkipSubtract(arg, dim)) {
             setMutable();
-            ptr_subtract(arg, dim);
+            ptr_subtract(arg, dim, disjoint_subtraction);
         }
         return down();
     }
 
+    static inline bool fed_isParallel(const fed_t& fed)
+    {
+        return operation_pool && fed.size() >= operation_threshold && fed.getDimension() > 1;
+    }
+
+    // Apply op(raw DBM) to the DBMs of fed with the pool, op returning
+    // false if the DBM becomes empty. The allocators are not thread safe so
+    // the DBMs are made mutable before and the empty ones are removed after
+    // by the calling thread, in the order of the sequential loop. Like the
+    // ptr_ functions of dbm_t, the DBMs for which changes(raw DBM) is false
+    // are left untouched and keep their minimal graph and hash value.
+    template <typename Changes, typename Operation>
+    static void fed_parallelApply(fed_t& fed, Changes changes, Operation op)
+    {
+        auto dbms = std::vector<raw_t*>(fed.size());
+        size_t k = 0;
+        for (auto& i : fed.as_mutable()) {
+            dbms[k++] = changes(i.const_dbm()) ? i.getCopy() : nullptr;
+        }
+        auto nonEmpty = std::vector<char>(dbms.size(), true);
+        operation_pool->run(dbms.size(), [&](size_t n) {
+            if (dbms[n]) {
+                nonEmpty[n] = op(dbms[n]);
+            }
+        });
+        k = 0;
+        for (fed_t::iterator it = fed.begin_mutable(), e = fed.end_mutable(); it != e; ++k) {
+            if (nonEmpty[k]) {
+                ++it;
+            } else {
+                it.remove();
+            }
+        }
+    }
+
+    // For operations without a cheap test, as the sequential loops of the
+    // extrapolations and the relaxations: every DBM is made mutable.
+    template <typename Operation>
+    static void fed_parallelApply(fed_t& fed, Operation op)
+    {
+        fed_parallelApply(fed, [](const raw_t*) { return true; }, op);
+    }
+
+    // @return true if one of the constraints tightens dbm, see dbm_t::ptr_constrain.
+    static bool fed_tightens(const raw_t* dbm, cindex_t dim, const cindex_t* table, const constraint_t* c, size_t n)
+    {
+        for (size_t k = 0; k < n; ++k) {
+            cindex_t i = table ? table[c[k].i] : c[k].i;
+            cindex_t j = table ? table[c[k].j] : c[k].j;
+            assert(i < dim && j < dim);
+            if (dbm[i * dim + j] > c[k].value) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // @return true if dbm_down changes dbm, see dbm_t::ptr_down.
+    static bool fed_downChanges(const raw_t* dbm, cindex_t dim)
+    {
+        for (cindex_t j = 1; j < dim; ++j) {
+            if (dbm[j] < dbm_LE_ZERO) {
+                raw_t min = dbm_LE_ZERO;
+                for (cindex_t i = 1; i < dim; ++i) {
+                    min = std::min(min, dbm[i * dim + j]);
+                }
+                if (min != dbm[j]) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
     bool fed_t::constrain(cindex_t i, int32_t value)
     {
         assert(isOK());
+        if (fed_isParallel(*this)) {
+            cindex_t dim = getDimension();
+            raw_t upper = dbm_bound2raw(value, dbm_WEAK);
+            raw_t lower = dbm_bound2raw(-value, dbm_WEAK);
+            fed_parallelApply(
+                *this, [&](const raw_t* dbm) { return dbm[i * dim] > upper || dbm[i] > lower; },
+                [&](raw_t* dbm) { return dbm_constrainClock(dbm, dim, i, value); });
+            return !isEmpty();
+        }
         for (iterator it = begin_mutable(), e = end_mutable(); it != e;) {
             if (it->ptr_constrain(i, value)) {
                 ++it;
@@ -1688,6 +2441,13 @@ namespace dbm
     bool fed_t::constrain(cindex_t i, cindex_t j, raw_t c)
     {
         assert(isOK());
+        if (fed_isParallel(*this)) {
+            cindex_t dim = getDimension();
+            fed_parallelApply(
+                *this, [&](const raw_t* dbm) { return dbm[i * dim + j] > c; },
+                [&](raw_t* dbm) { return dbm_constrain1(dbm, dim, i, j, c); });
+            return !isEmpty();
+        }
         for (iterator it = begin_mutable(), e = end_mutable(); it != e;) {
             if (it->ptr_constrain(i, j, c)) {
                 ++it;
@@ -1708,6 +2468,13 @@ namespace dbm
             return constrain(c->i, c->j, c->value);
         }
 
+        if (fed_isParallel(*this)) {
+            cindex_t dim = getDimension();
+            fed_parallelApply(
+                *this, [&](const raw_t* dbm) { return fed_tightens(dbm, dim, nullptr, c, n); },
+                [&](raw_t* dbm) { return dbm_constrainN(dbm, dim, c, n); });
+            return !isEmpty();
+        }
         for (iterator it = begin_mutable(), e = end_mutable(); it != e;) {
             if (it->ptr_constrain(c, n)) {
                 ++it;
@@ -1721,6 +2488,13 @@ namespace dbm
     bool fed_t::constrain(const cindex_t* table, const constraint_t* c, size_t n)
     {
         assert(isOK());
+        if (fed_isParallel(*this)) {
+            cindex_t dim = getDimension();
+            fed_parallelApply(
+                *this, [&](const raw_t* dbm) { return fed_tightens(dbm, dim, table, c, n); },
+                [&](raw_t* dbm) { return dbm_constrainIndexedN(dbm, dim, table, c, n); });
+            return !isEmpty();
+        }
         for (iterator it = begin_mutable(), e = end_mutable(); it != e;) {
             if (it->ptr_constrain(table, c, n)) {
                 ++it;
@@ -1755,20 +2529,30 @@ namespace dbm
         } else if (arg.isEmpty()) {
             return false;
         } else {
-            size_t argSize = arg.size();
-            std::vector<const raw_t*> argDBM(argSize);
-            arg.toArray(argDBM.data());
-
             // check cross-intersections
             cindex_t dim = getDimension();
+            const FedIndex* index = fed_getIndex(ifed());
+            const fed_t* other = &arg;
+            if (index == nullptr && (index = fed_getIndex(arg.ifed())) != nullptr) {
+                other = this;
+            }
+            if (index) {
+                for (const auto& j : *other) {
+                    const raw_t* dbm = j.const_dbm();
+                    if (fed_anyIntersecting(index, dbm, dim, [&](const dbm_t& i) {
+                            return dbm_haveIntersection(i.const_dbm(), dbm, dim);
+                        })) {
+                        return true;
+                    }
+                }
+                return false;
+            }
             for (const auto& i : *this) {
-                uint32_t j = 0;
-                do {
-                    assert(argDBM[j]);
-                    if (dbm_haveIntersection(i.const_dbm(), argDBM[j], dim)) {
+                for (const auto& j : arg) {
+                    if (!i.hasDisjointBounds(j) && dbm_haveIntersection(i.const_dbm(), j.const_dbm(), dim)) {
                         return true;
                     }
-                } while (++j < argSize);
+                }
             }
             return false;
         }
@@ -1792,8 +2576,12 @@ namespace dbm
         assert(dim == getDimension());
         assertx(dbm_isValid(arg, dim));
 
+        if (const FedIndex* index = fed_getIndex(ifed())) {
+            return fed_anyIntersecting(index, arg, dim,
+                                       [&](const dbm_t& i) { return dbm_haveIntersection(i.const_dbm(), arg, dim); });
+        }
         for (const auto& i : *this) {
-            if (dbm_haveIntersection(i.const_dbm(), arg, dim)) {
+            if (!i.hasDisjointBounds(arg, dim) && dbm_haveIntersection(i.const_dbm(), arg, dim)) {
                 return true;
             }
         }
@@ -1803,6 +2591,24 @@ namespace dbm
     fed_t& fed_t::up()
     {
         assert(isOK());
+        if (fed_isParallel(*this)) {
+            cindex_t dim = getDimension();
+            fed_parallelApply(
+                *this,
+                [&](const raw_t* dbm) {
+                    for (cindex_t i = 1; i < dim; ++i) {
+                        if (dbm[i * dim] != dbm_LS_INFINITY) {
+                            return true;
+                        }
+                    }
+                    return false;
+                },
+                [&](raw_t* dbm) {
+                    dbm_up(dbm, dim);
+                    return true;
+                });
+            return *this;
+        }
         for (auto& i : as_mutable())
             i.ptr_up();
         return *this;
@@ -1833,6 +2639,16 @@ namespace dbm
     fed_t& fed_t::down()
     {
         assert(isOK());
+        if (fed_isParallel(*this)) {
+            cindex_t dim = getDimension();
+            fed_parallelApply(
+                *this, [&](const raw_t* dbm) { return fed_downChanges(dbm, dim); },
+                [&](raw_t* dbm) {
+                    dbm_down(dbm, dim);
+                    return true;
+                });
+            return *this;
+        }
         for (auto& i : as_mutable())
             i.ptr_down();
         return *this;
@@ -1841,6 +2657,25 @@ namespace dbm
     fed_t& fed_t::freeClock(cindex_t clock)
     {
         assert(isOK());
+        if (fed_isParallel(*this)) {
+            cindex_t dim = getDimension();
+            fed_parallelApply(
+                *this,
+                [&](const raw_t* dbm) {
+                    for (cindex_t i = 0; i < dim; ++i) {
+                        if (i != clock &&
+                            (dbm[clock * dim + i] != dbm_LS_INFINITY || dbm[i * dim + clock] != dbm[i * dim])) {
+                            return true;
+                        }
+                    }
+                    return false;
+                },
+                [&](raw_t* dbm) {
+                    dbm_freeClock(dbm, dim, clock);
+                    return true;
+                });
+            return *this;
+        }
         for (auto& i : as_mutable())
             i.ptr_freeClock(clock);
         return *this;
@@ -1881,6 +2716,27 @@ namespace dbm
     void fed_t::updateValue(cindex_t x, int32_t v)
     {
         assert(isOK());
+        if (fed_isParallel(*this)) {
+            cindex_t dim = getDimension();
+            raw_t dk0 = dbm_bound2raw(v, dbm_WEAK);
+            raw_t d0k = dbm_bound2raw(-v, dbm_WEAK);
+            fed_parallelApply(
+                *this,
+                [&](const raw_t* dbm) {
+                    for (cindex_t i = 0; i < dim; ++i) {
+                        if (dbm[x * dim + i] != dbm_addFiniteRaw(dk0, dbm[i]) ||
+                            dbm[i * dim + x] != dbm_addRawFinite(dbm[i * dim], d0k)) {
+                            return true;
+                        }
+                    }
+                    return false;
+                },
+                [&](raw_t* dbm) {
+                    dbm_updateValue(dbm, dim, x, v);
+                    return true;
+                });
+            return;
+        }
         for (auto& i : as_mutable())
             i.ptr_updateValue(x, v);
     }
@@ -1961,6 +2817,14 @@ namespace dbm
     fed_t& fed_t::relaxUpClock(cindex_t clock)
     {
         assert(isOK());
+        if (fed_isParallel(*this)) {
+            cindex_t dim = getDimension();
+            fed_parallelApply(*this, [&](raw_t* dbm) {
+                dbm_relaxUpClock(dbm, dim, clock);
+                return true;
+            });
+            return *this;
+        }
         for (auto& i : as_mutable())
             i.ptr_relaxUpClock(clock);
         return *this;
@@ -1969,6 +2833,14 @@ namespace dbm
     fed_t& fed_t::relaxDownClock(cindex_t clock)
     {
         assert(isOK());
+        if (fed_isParallel(*this)) {
+            cindex_t dim = getDimension();
+            fed_parallelApply(*this, [&](raw_t* dbm) {
+                dbm_relaxDownClock(dbm, dim, clock);
+                return true;
+            });
+            return *this;
+        }
         for (auto& i : as_mutable())
             i.ptr_relaxDownClock(clock);
         return *this;
@@ -2028,28 +2900,73 @@ namespace dbm
         return *this;
     }
 
+    fed_t& fed_t::expensiveReduce() { return expensiveReduce(nullptr); }
+
+    fed_t& fed_t::expensiveReduce(budget_t& budget) { return expensiveReduce(&budget); }
+
+    fed_t& fed_t::mergeReduce(budget_t& budget, size_t skip, int level)
+    {
+        assert(isOK());
+        ifed_t::reduced_t reduced = ifedPtr->getReduced();
+        if (level == 0) {
+            skip = std::max<size_t>(skip, reduced[ifed_t::REDUCED_MERGE]);
+        }
+        size_t before = size();
+        ifed()->mergeReduce(getDimension(), skip, level, &budget);
+        ifedPtr->setReduced(budget.wasInterrupted() ? ifed_t::NB_REDUCED : ifed_t::REDUCED_MERGE, reduced, skip,
+                            before);
+        return *this;
+    }
+
     // Keep DBMs that are not included in others
-    // and remove DBMs that are included.
-    fed_t& fed_t::expensiveReduce()
+    // and remove DBMs that are included. The DBMs already
+    // reduced are not included in the union of the others
+    // among them, so they are checked only if they intersect
+    // one of the new DBMs.
+    fed_t& fed_t::expensiveReduce(budget_t* budget)
     {
         assert(isOK());
 
         // at least 2 DBMs
         if (size() > 1) {
+            ifed_t::reduced_t reduced = ifedPtr->getReduced();
+            size_t skip = reduced[ifed_t::REDUCED_UNION];
+            size_t before = size();
+            std::vector<const fdbm_t*> fresh;  // new DBMs
+            const fdbm_t* f = ifed()->const_head();
+            for (size_t k = 0; f != nullptr; f = f->getNext(), ++k) {
+                if (k >= skip) {
+                    fresh.push_back(f);
+                }
+            }
+
             // side effect on all copies
             fdbm_t** fdbm = ifed()->atHead();
+            size_t old = skip;  // reduced DBMs left
             do {
                 assert(size() > 1);
+                if (old != 0) {
+                    --old;
+                    const dbm_t& dbm = (*fdbm)->const_dbmt();
+                    if (std::none_of(fresh.begin(), fresh.end(),
+                                     [&dbm](const fdbm_t* n) { return dbm.intersects(n->const_dbmt()); })) {
+                        fdbm = (*fdbm)->getNextMutable();
+                        continue;
+                    }
+                }
+                if (budget != nullptr && !budget->spend(size())) {
+                    break;  // the list is consistent
+                }
 
                 // remove fdbm from the list
                 fdbm_t* current = *fdbm;
                 *fdbm = current->getNext();
-                ifedPtr->decSize();
+                ifed()->decSize();
 
                 // this - current = empty <=> this <= current
                 if (isSubtractionEmpty(current->const_dbmt())) {
                     // this = current, finished!
-                    ifedPtr->setDBM(current);
+                    ifed()->setDBM(current);
                     break;
                 } else if (current->const_dbmt().isSubtractionEmpty(*this)) {
                     // current - this = empty <=> current <= this
@@ -2060,23 +2977,30 @@ namespace dbm
                         break;
                 } else {
                     *fdbm = current;  // put it back
-                    ifedPtr->incSize();
+                    ifed()->incSize();
                     fdbm = current->getNextMutable();  // and continue
                 }
             } while (*fdbm != nullptr);
+
+            bool interrupted = budget != nullptr && budget->wasInterrupted();
+            ifedPtr->setReduced(interrupted ? ifed_t::NB_REDUCED : ifed_t::REDUCED_UNION, reduced, skip, before);
         }
         return *this;
     }
 
+    // Not incremental: skipped only if nothing changed since the last one.
     fed_t& fed_t::convexReduce()
     {
         assert(isOK());
+        ifed_t::reduced_t reduced = ifedPtr->getReduced();
+        size_t before = size();
         // at least 2 DBMs
-        if (size() > 1) {
+        if (before > 1 && reduced[ifed_t::REDUCED_CONVEX] != before) {
             DODEBUGX(fed_t checkFed = *this);
             DODEBUGX(checkFed.setMutable());
             fdbm_t** head = ifed()->atHead();  // side effect on all copies
             cindex_t dim = getDimension();
+            fed_pivot_t pivot(dim);
             CERR("[" << size() << ":");
             for (fdbm_t** fi = head; *fi != nullptr;) {
             next_fi:
@@ -2087,55 +3011,25 @@ namespace dbm
             compute_convexi:
                 dbm_t convexi = dbmi;
                 const raw_t* dbm1 = dbmi.const_dbm();
+                pivot.set(dbm1);
                 for (fdbm_t** fj = (*fi)->getNextMutable(); *fj != nullptr;) {
                     const dbm_t& dbmj = (*fj)->const_dbmt();
                     const raw_t* dbm2 = dbmj.const_dbm();
-                    bool subset = true, superset = true;
-                    bool compatible = (dim <= 2);
-                    bool symCompatible = compatible;
-                    for (cindex_t i = 1; i < dim; ++i) {
-                        for (cindex_t j = 0; j < i; ++j) {
-                            uint32_t ij = i * dim + j;
-                            uint32_t ji = j * dim + i;
-
-#ifndef IMPROVED_MERGE
-                            // No intersection for sure
-                            if ((dbm1[ij] != dbm_LS_INFINITY && dbm2[ji] != dbm_LS_INFINITY &&
-                                 dbm_negRaw(dbm_weakRaw(dbm1[ij])) >= dbm_weakRaw(dbm2[ji])) ||
-                                (dbm1[ji] != dbm_LS_INFINITY && dbm2[ij] != dbm_LS_INFINITY &&
-                                 dbm_negRaw(dbm_weakRaw(dbm1[ji])) >= dbm_weakRaw(dbm2[ij]))) {
-                                goto DifferentDBMs;
-                            }
-#else
-                            // Will try only weakly non disjoint DBMs only.
-                            // No intersection for sure
-                            if (fed_checkWeakAdd(dbm1[ij], dbm2[ji]) || fed_checkWeakAdd(dbm1[ji], dbm2[ij])) {
-                                goto DifferentDBMs;
-                            }
-#endif
-                            // Check DBMs, no jump everything goes in the pipeline.
-                            bool comp1 = dbm1[ij] == dbm2[ij];
-                            compatible |= comp1;
-                            subset &= dbm1[ij] <= dbm2[ij];
-                            superset &= dbm1[ij] >= dbm2[ij];
-                            bool comp2 = dbm1[ji] == dbm2[ji];
-                            compatible |= comp2;
-                            symCompatible |= comp1 && comp2;
-                            subset &= dbm1[ji] <= dbm2[ji];
-                            superset &= dbm1[ji] >= dbm2[ji];
-                        }
+                    fed_pair_t pair = pivot.compare(dbm2);
+                    if (pair.disjoint) {
+                        goto DifferentDBMs;
                     }
-                    if (subset) {  // fi <= fj -> remove fi, put back removedj, reloop
+                    if (pair.subset) {  // fi <= fj -> remove fi, put back removedj, reloop
                         CERR(GREEN(THIN) "X" NORMAL);
                         *fi = (*fi)->removeAndNext();
-                        ifedPtr->decSize();
-                        ifedPtr->stealFromToEnd(fi, *removedj.ifedPtr);
+                        ifed()->decSize();
+                        ifed()->stealFromToEnd(fi, *removedj.ifed());
                         goto new_convexi;
-                    } else if (superset) {  // fi >= fj -> remove fj, continue
+                    } else if (pair.superset) {  // fi >= fj -> remove fj, continue
                         CERR(GREEN(THIN) "x" NORMAL);
                         *fj = (*fj)->removeAndNext();
-                        ifedPtr->decSize();
-                    } else if (symCompatible) {
+                        ifed()->decSize();
+                    } else if (pair.compatible && (dim <= 2 || fed_compatibleRows(dbm1, dbm2, dim) > 0)) {
                         // try merge 2 by 2
                         dbm_t tryMerge = dbmi;
                         tryMerge += dbmj;
@@ -2144,18 +3038,18 @@ namespace dbm
                             CERR(MAGENTA(THIN) "m" NORMAL);
                             (*fi)->dbmt().updateCopy(tryMerge);
                             *fj = (*fj)->removeAndNext();
-                            ifedPtr->decSize();
+                            ifed()->decSize();
                             // put back removedj since convexi will be recomputed
-                            ifedPtr->stealFromToEnd(fi, *removedj.ifedPtr);
+                            ifed()->stealFromToEnd(fi, *removedj.ifed());
                             goto compute_convexi;
                         } else {
                             goto OnlyCompatible;
                         }
-                    } else if (compatible) {
+                    } else if (pair.compatible) {
                     OnlyCompatible:
                         CERR(YELLOW(THIN) "+" NORMAL);
                         convexi += dbmj;
-                        removedj.ifedPtr->steal(fj, *ifedPtr);
+                        removedj.ifed()->steal(fj, *ifed());
                     } else {
                     DifferentDBMs:
                         // ignore fj
@@ -2170,7 +3064,7 @@ namespace dbm
                         // if (dbmj <= convexi)
                         if (dbm_isSubsetEq(dbmj.const_dbm(), convexi.const_dbm(), dim)) {
                             CERR(YELLOW(BOLD) "+" NORMAL);
-                            removedj.ifedPtr->steal(fj, *ifedPtr);
+                            removedj.ifed()->steal(fj, *ifed());
                         } else {
                             fj = (*fj)->getNextMutable();
                         }
@@ -2194,8 +3088,8 @@ namespace dbm
                         if (newFed.size() <= removedj.size()) {  // <= because dbmi not in removedj
                             CERR(GREEN(BOLD) "R(" << (1 + removedj.size() - newFed.size()) << ")" NORMAL);
                             *fi = (*fi)->removeAndNext();  // remove fi since inside newFed
-                            ifedPtr->decSize();
-                            ifedPtr->stealFromToEnd(fi, *newFed.ifedPtr);
+                            ifed()->decSize();
+                            ifed()->stealFromToEnd(fi, *newFed.ifed());
                             goto next_fi;
                         }
                         assert(removedj.isMutable());
@@ -2204,22 +3098,22 @@ namespace dbm
                         if (removedj.add(dbmi).expensiveReduce().ifedPtr->const_head()->const_dbmt().sameAs(dbmi)) {
                             CERR(RED(THIN) "B(" << (newFed.size() - 1 - removedj.size()) << ")" NORMAL);
                             // dbmi still there, but in fi too
-                            removedj.ifedPtr->removeHead();
+                            removedj.ifed()->removeHead();
                             fi = (*fi)->getNextMutable();
                         } else {
                             CERR(MAGENTA(THIN) "R" NORMAL);
                             // dbmi was reduced, don't need in fi
                             *fi = (*fi)->removeAndNext();
-                            ifedPtr->decSize();
+                            ifed()->decSize();
                         }
                         // Put back removedj to end (don't mess-up loop on fi).
-                        ifedPtr->stealFromToEnd(fi, *removedj.ifedPtr);
+                        ifed()->stealFromToEnd(fi, *removedj.ifed());
                         goto next_fi;
 
 #else
                         CERR(RED(THIN) "B(" << (newFed.size() - 1 - removedj.size()) << ")" NORMAL);
                         // Put back removedj to end (don't mess-up loop on fi).
-                        ifedPtr->stealFromToEnd(fi, *removedj.ifedPtr);
+                        ifed()->stealFromToEnd(fi, *removedj.ifed());
 #endif
                     }
                 }
@@ -2227,22 +3121,58 @@ namespace dbm
             }  // for(fi..)
             CERR(":" << size() << "]");
             assertx(eq(checkFed));
+            ifedPtr->setReduced(ifed_t::REDUCED_CONVEX, reduced, 0, before);
         }
         return *this;
     }
 
-    fed_t& fed_t::expensiveConvexReduce()
+    fed_t& fed_t::expensiveConvexReduce() { return expensiveConvexReduce(nullptr); }
+
+    fed_t& fed_t::expensiveConvexReduce(budget_t& budget) { return expensiveConvexReduce(&budget); }
+
+    // fed -= arg one DBM at a time, each subtraction costs the
+    // current size of fed.
+    // @return false if the budget ran out, then fed is only
+    // partially subtracted.
+    static bool fed_subtract(fed_t& fed, const fed_t& arg, budget_t* budget)
+    {
+        if (budget == nullptr) {
+            fed -= arg;
+            return true;
+        }
+        for (const auto& dbm : arg) {
+            if (fed.isEmpty()) {
+                break;
+            }
+            if (!budget->spend(fed.size())) {
+                return false;
+            }
+            fed -= dbm;
+        }
+        return true;
+    }
+
+    // With a budget, abort if it runs out before the end of the
+    // subtractions. The merge reductions may stop early since the
+    // intermediate federations are still valid.
+    fed_t& fed_t::expensiveConvexReduce(budget_t* budget)
     {
         assert(isOK());
 
         if (size() > 1) {
+            if (budget != nullptr && !budget->spend(size())) {
+                return *this;
+            }
             const_iterator i = begin(), e = end();
             dbm_t c = *i;
             for (++i; i != e; ++i)
                 c += *i;
             auto newFed = fed_t{c};
-            fed_t excess = fed_t(c) -= *this;
+            fed_t excess = fed_t{c};
             c.nil();
+            if (!fed_subtract(excess, *this, budget)) {
+                return *this;  // Abort.
+            }
 
             // Simpler to take all-excess with excess=all-this
             // but it is not always better.
@@ -2250,16 +3180,23 @@ namespace dbm
             // newFed.setInit();
             // fed_t excess = fed_t(newFed) -= *this;
 
-            if (excess.size() > 5 * size() ||  // heuristic to abort before mergeReduce
-                excess.mergeReduce().size() > size()) {
+            if (excess.size() > 5 * size()) {  // heuristic to abort before mergeReduce
+                return *this;                  // Abort.
+            }
+            excess.ifed()->mergeReduce(getDimension(), 0, 0, budget);
+            if (excess.size() > size() || (budget != nullptr && !budget->spend(excess.size()))) {
                 return *this;  // Abort.
             }
 
-            newFed -= excess;
-            if (newFed.size() < 3 * (excess.size() + size()) &&  // another heuristic :)
-                newFed.mergeReduce().size() < size()) {
+            if (!fed_subtract(newFed, excess, budget)) {
+                return *this;  // Abort.
+            }
+            if (newFed.size() < 3 * (excess.size() + size())) {  // another heuristic :)
+                newFed.ifed()->mergeReduce(getDimension(), 0, 0, budget);
+            }
+            if (newFed.size() < size()) {
                 CERR(GREEN(BOLD) "[" << (size() - newFed.size()) << "]" NORMAL);
-                ifedPtr->swap(*newFed.ifedPtr);  // win
+                ifed()->swap(*newFed.ifed());  // win
             } else                               // lose
             {
                 CERR(RED(BOLD) "[" << (newFed.size() - size()) << "]" NORMAL);
@@ -2288,10 +3225,10 @@ namespace dbm
 
             for (fdbm_t** head = ifed()->atHead(); *head != nullptr;) {
                 // Partition initialized with D
-                partition.ifedPtr->steal(head, *ifedPtr);
+                partition.ifed()->steal(head, *ifed());
 
                 // Loop on DBMs i of partition
-                fdbm_t *fi, **endi = partition.ifedPtr->atHead();
+                fdbm_t *fi, **endi = partition.ifed()->atHead();
                 for (fi = *endi, endi = (*endi)->getNextMutable(); fi != nullptr; fi = fi->getNext()) {
                     const raw_t* dbmi = fi->const_dbmt().const_dbm();
                     assert(*endi == nullptr);  // end of partition
@@ -2299,7 +3236,7 @@ namespace dbm
                     for (fdbm_t** fj = head; *fj != nullptr;) {
                         if (dbm_relaxedIntersection(tmp.dbm(), dbmi, (*fj)->const_dbmt().const_dbm(), dim)) {
                             // move fj to end of partition, update end
-                            endi = partition.ifedPtr->steal(endi, fj, *ifedPtr);
+                            endi = partition.ifed()->steal(endi, fj, *ifed());
                         } else {
                             fj = (*fj)->getNextMutable();
                         }
@@ -2327,8 +3264,8 @@ namespace dbm
             }
             // Transfer result to this federation
             assert(isEmpty());
-            ifedPtr->copyRef(*reducedFed.ifedPtr);
-            reducedFed.ifedPtr->reset();
+            ifed()->copyRef(*reducedFed.ifed());
+            reducedFed.ifed()->reset();
 
             CERR(":" << size() << ">");
         }
@@ -2340,9 +3277,33 @@ namespace dbm
         assert(isOK());
         assert(point.size() == getDimension());
 
-        return std::any_of(begin(), end(), [p = point.data(), dim = getDimension()](const dbm_t& dbm) {
-            return dbm_isPointIncluded(p, dbm.const_dbm(), dim);
-        });
+        const int32_t* pt = point.data();
+        cindex_t dim = getDimension();
+        if (const FedIndex* index = fed_getIndex(ifed())) {
+            return index->search(
+                [&](const raw_t* upper, const raw_t* lower) {
+                    for (cindex_t i = 1; i < dim; ++i) {
+                        if (dbm_bound2raw(pt[i] - pt[0], dbm_WEAK) > upper[i] ||
+                            dbm_bound2raw(pt[0] - pt[i], dbm_WEAK) > lower[i]) {
+                            return true;
+                        }
+                    }
+                    return false;
+                },
+                [&](size_t, const dbm_t& dbm) { return dbm_isPointIncluded(pt, dbm.const_dbm(), dim); });
+        }
+        return std::any_of(begin(), end(),
+                           [&](const dbm_t& dbm) { return dbm_isPointIncluded(pt, dbm.const_dbm(), dim); });
+    }
+
+    // Same test as dbm_isRealPointIncluded: x - y does not satisfy c.
+    static inline bool fed_isOutside(double x, double y, raw_t c)
+    {
+        if (c == dbm_LS_INFINITY) {
+            return false;
+        }
+        double bound = dbm_raw2bound(c);
+        return dbm_rawIsStrict(c) ? IS_GE(x, y + bound) : IS_GT(x, y + bound);
     }
 
     bool fed_t::contains(const std::vector<double>& point) const
@@ -2350,9 +3311,22 @@ namespace dbm
         assert(isOK());
         assert(point.size() == getDimension());
 
-        return std::any_of(begin(), end(), [p = point.data(), dim = getDimension()](const dbm_t& dbm) {
-            return dbm_isRealPointIncluded(p, dbm.const_dbm(), dim);
-        });
+        const double* pt = point.data();
+        cindex_t dim = getDimension();
+        if (const FedIndex* index = fed_getIndex(ifed())) {
+            return index->search(
+                [&](const raw_t* upper, const raw_t* lower) {
+                    for (cindex_t i = 1; i < dim; ++i) {
+                        if (fed_isOutside(pt[i], pt[0], upper[i]) || fed_isOutside(pt[0], pt[i], lower[i])) {
+                            return true;
+                        }
+                    }
+                    return false;
+                },
+                [&](size_t, const dbm_t& dbm) { return dbm_isRealPointIncluded(pt, dbm.const_dbm(), dim); });
+        }
+        return std::any_of(begin(), end(),
+                           [&](const dbm_t& dbm) { return dbm_isRealPointIncluded(pt, dbm.const_dbm(), dim); });
     }
 
     static inline double fed_diff(double value, raw_t low)
@@ -2568,6 +3542,13 @@ namespace dbm
     {
         assert(isOK());
         cindex_t dim = getDimension();
+        if (fed_isParallel(*this)) {
+            fed_parallelApply(*this, [&](raw_t* dbm) {
+                dbm_extrapolateMaxBounds(dbm, dim, max);
+                return true;
+            });
+            return;
+        }
         for (auto& i : as_mutable())
             dbm_extrapolateMaxBounds(i.getCopy(), dim, max);
     }
@@ -2576,6 +3557,13 @@ namespace dbm
     {
         assert(isOK());
         cindex_t dim = getDimension();
+        if (fed_isParallel(*this)) {
+            fed_parallelApply(*this, [&](raw_t* dbm) {
+                dbm_diagonalExtrapolateMaxBounds(dbm, dim, max);
+                return true;
+            });
+            return;
+        }
         for (auto& i : as_mutable())
             dbm_diagonalExtrapolateMaxBounds(i.getCopy(), dim, max);
     }
@@ -2584,6 +3572,13 @@ namespace dbm
     {
         assert(isOK());
         cindex_t dim = getDimension();
+        if (fed_isParallel(*this)) {
+            fed_parallelApply(*this, [&](raw_t* dbm) {
+                dbm_extrapolateLUBounds(dbm, dim, lower, upper);
+                return true;
+            });
+            return;
+        }
         for (auto& i : as_mutable())
             dbm_extrapolateLUBounds(i.getCopy(), dim, lower, upper);
     }
@@ -2592,6 +3587,13 @@ namespace dbm
     {
         assert(isOK());
         cindex_t dim = getDimension();
+        if (fed_isParallel(*this)) {
+            fed_parallelApply(*this, [&](raw_t* dbm) {
+                dbm_diagonalExtrapolateLUBounds(dbm, dim, lower, upper);
+                return true;
+            });
+            return;
+        }
         for (auto& i : as_mutable())
             dbm_diagonalExtrapolateLUBounds(i.getCopy(), dim, lower, upper);
     }
@@ -2737,6 +3739,119 @@ namespace dbm
         const_dbmt().getValuation(cval, freeC);
     }
 
+    // Write the size of a federation and its DBMs in order.
+    static void predt_write(std::vector<raw_t>& out, const fed_t& fed)
+    {
+        size_t dim2 = fed.getDimension() * fed.getDimension();
+        out.push_back(static_cast<raw_t>(fed.size()));
+        for (const auto& dbm : fed) {
+            out.insert(out.end(), dbm.const_dbm(), dbm.const_dbm() + dim2);
+        }
+    }
+
+    static std::vector<raw_t> predt_args(predt_kind_t kind, const fed_t& good, const fed_t& bad, const raw_t* restrict)
+    {
+        cindex_t dim = good.getDimension();
+        auto args = std::vector<raw_t>{kind, static_cast<raw_t>(dim)};
+        predt_write(args, good);
+        predt_write(args, bad);
+        if (restrict != nullptr) {
+            args.insert(args.end(), restrict, restrict + dim * dim);
+        }
+        return args;
+    }
+
+    // Hash of the arguments, from the hash values of the federations that
+    // interned federations keep, so nothing is copied to look up a memo.
+    static uint32_t predt_hash(predt_kind_t kind, const fed_t& good, const fed_t& bad, const raw_t* restrict)
+    {
+        cindex_t dim = good.getDimension();
+        uint32_t hashes[4] = {good.hash(), bad.hash(), restrict ? hash_computeI32(restrict, dim * dim, 0) : 0,
+                              static_cast<uint32_t>(kind) | (dim << 1)};
+        return hash_computeU32(hashes, 4, 0);
+    }
+
+    // @return true if fed was written by predt_write at args[pos],
+    // pos is then moved after it.
+    static bool predt_equal(const std::vector<raw_t>& args, size_t& pos, const fed_t& fed)
+    {
+        size_t dim2 = fed.getDimension() * fed.getDimension();
+        if (pos >= args.size() || args[pos++] != static_cast<raw_t>(fed.size())) {
+            return false;
+        }
+        assert(pos + fed.size() * dim2 <= args.size());
+        for (const auto& dbm : fed) {
+            if (!std::equal(dbm.const_dbm(), dbm.const_dbm() + dim2, args.begin() + pos)) {
+                return false;
+            }
+            pos += dim2;
+        }
+        return true;
+    }
+
+    // @return true if args = predt_args(kind, good, bad, restrict).
+    static bool predt_matches(const std::vector<raw_t>& args, predt_kind_t kind, const fed_t& good, const fed_t& bad,
+                              const raw_t* restrict)
+    {
+        cindex_t dim = good.getDimension();
+        size_t pos = 2;
+        if (args[0] != kind || args[1] != static_cast<raw_t>(dim) || !predt_equal(args, pos, good) ||
+            !predt_equal(args, pos, bad)) {
+            return false;
+        }
+        return restrict == nullptr ? pos == args.size()
+                                   : pos + dim * dim == args.size() &&
+                                         std::equal(restrict, restrict + dim * dim, args.begin() + pos);
+    }
+
+    // @return the memo of the arguments, now the most recent, or nullptr.
+    // Contents are compared only for the memos with the same hash.
+    static const predt_memo_t* predt_find(uint32_t hash, predt_kind_t kind, const fed_t& good, const fed_t& bad,
+                                          const raw_t* restrict)
+    {
+        auto range = predt_memo_index.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (predt_matches(it->second->args, kind, good, bad, restrict)) {
+                predt_memo.splice(predt_memo.begin(), predt_memo, it->second);  // iterators stay valid
+                return &predt_memo.front();
+            }
+        }
+        return nullptr;
+    }
+
+    // Remember a result, the arguments are copied only here.
+    static void predt_store(uint32_t hash, predt_kind_t kind, const fed_t& good, const fed_t& bad,
+                            const raw_t* restrict, const fed_t& result, bool success)
+    {
+        predt_memo.push_front({hash, predt_args(kind, good, bad, restrict), {}, success});
+        predt_write(predt_memo.front().result, result);
+        predt_memo_index.emplace(hash, predt_memo.begin());
+        if (predt_memo.size() > predt_memo_capacity) {
+            predt_evict();
+        }
+    }
+
+    static fed_t predt_read(const predt_memo_t& memo, cindex_t dim)
+    {
+        return fed_t(&memo.result[1], static_cast<size_t>(memo.result[0]), dim);
+    }
+
+    // predt(good, bad) for one good and one bad DBM that intersects down(good),
+    // given downBad = down(bad) restricted.
+    static fed_t predt(const dbm_t& good, const dbm_t& downGood, const dbm_t& bad, const dbm_t& downBad,
+                       const raw_t* restrict)
+    {
+        fed_t result = downGood;
+        result -= downBad;
+        dbm_t goodAndDownBad = downBad;
+        fed_t part = (goodAndDownBad &= good) - bad;
+        part.down();
+        if (restrict != nullptr) {
+            part &= restrict;
+        }
+        return result.steal(part);
+    }
+
     // predt(union good, union bad) = union_good intersection_bad predt(good, bad)
     fed_t& fed_t::predt(const fed_t& bad, const raw_t* restrict)
     {
@@ -2747,56 +3862,64 @@ namespace dbm
         if (sameAs(bad)) {
             setEmpty();
             return *this;
-        } else if (bad.size() == 1) {
-            return predt(bad.const_dbmt(), restrict);
         } else if (bad.isEmpty()) {
             return restrict != nullptr ? down() &= restrict : down();
         } else if (!isEmpty()) {
-            fed_t result(getDimension());
-            for (const auto& goods : *this) {
-                // Predt for 1st bad.
-                const_iterator bads = bad.begin(), bad_e = bad.end();
-                dbm_t downGood = goods;
-                downGood.down();
-                if (restrict != nullptr) {
-                    downGood &= restrict;
+            cindex_t dim = getDimension();
+            fed_t good = *this;  // the arguments for the memo, shared and not copied
+            uint32_t hash = 0;
+            if (predt_memo_capacity != 0) {
+                hash = predt_hash(PREDT, *this, bad, restrict);
+                if (const predt_memo_t* memo = predt_find(hash, PREDT, *this, bad, restrict)) {
+                    return *this = predt_read(*memo, dim);
                 }
-                fed_t intersecPredt = downGood;
-                if (downGood.intersects(*bads)) {
-                    dbm_t downBad = *bads;
-                    downBad.down();
+            }
+
+            if (bad.size() == 1) {
+                predt(bad.const_dbmt(), restrict);
+            } else {
+                // down(bad) restricted, computed once for all the good DBMs.
+                auto downBads = std::vector<dbm_t>(bad.size(), dbm_t(dim));
+                auto getDownBad = [&](size_t k, const dbm_t& b) -> const dbm_t& {
+                    if (downBads[k].isEmpty()) {
+                        downBads[k] = b;
+                        downBads[k].down();
+                        if (restrict != nullptr) {
+                            downBads[k] &= restrict;
+                        }
+                    }
+                    return downBads[k];
+                };
+
+                fed_t result(dim);
+                for (const auto& goods : *this) {
+                    dbm_t downGood = goods;
+                    downGood.down();
                     if (restrict != nullptr) {
-                        intersecPredt -= (downBad &= restrict);
-                        intersecPredt.steal(((downBad &= goods) - *bads).down() &= restrict);
-                    } else {
-                        intersecPredt -= downBad;
-                        intersecPredt.steal(((downBad &= goods) - *bads).down());
+                        downGood &= restrict;
                     }
-                }
-                // Intersection with other predt.
-                for (++bads; bads != bad_e && !intersecPredt.isEmpty(); ++bads) {
+                    // Predt for 1st bad.
+                    const_iterator bads = bad.begin(), bad_e = bad.end();
+                    size_t k = 0;
+                    fed_t intersecPredt = downGood;
                     if (downGood.intersects(*bads)) {
-                        dbm_t downBad = *bads;
-                        downBad.down();
-                        fed_t part = downGood;
-                        if (restrict != nullptr) {
-                            part -= (downBad &= restrict);
-                            part.steal(((downBad &= goods) - *bads).down() &= restrict);
-                        } else {
-                            part -= downBad;
-                            part.steal(((downBad &= goods) - *bads).down());
+                        intersecPredt = dbm::predt(goods, downGood, *bads, getDownBad(k, *bads), restrict);
+                    }
+                    // Intersection with other predt.
+                    for (++bads, ++k; bads != bad_e && !intersecPredt.isEmpty(); ++bads, ++k) {
+                        if (downGood.intersects(*bads)) {
+                            intersecPredt &= dbm::predt(goods, downGood, *bads, getDownBad(k, *bads), restrict);
                         }
-                        intersecPredt &= part;
                     }
+                    // Union of partial predt.
+                    result.steal(intersecPredt);
                 }
-                // Union of partial predt.
-                result.steal(intersecPredt);
+                swap(result);
             }
 
-            // Swap federations.
-            ifed_t* ifed = ifedPtr;
-            ifedPtr = result.ifedPtr;
-            result.ifedPtr = ifed;
+            if (predt_memo_capacity != 0) {
+                predt_store(hash, PREDT, good, bad, restrict, *this, true);
+            }
         }
         return *this;
     }
@@ -2897,11 +4020,10 @@ namespace dbm
         return *this;
     }
 
-    static bool succt(fed_t& result, const dbm_t& good, const dbm_t& upGood, const dbm_t& bad)
+    static bool succt(fed_t& result, const dbm_t& good, const dbm_t& upGood, const dbm_t& bad, const dbm_t& upBad)
     {
         if (good <= bad)
             return true;
-        fed_t upBad = up(bad);
         result = upGood;
         (result -= upBad) |= ((fed_t(good) &= upBad) -= bad).up();
         fed_t copy = result;
@@ -2925,25 +4047,54 @@ namespace dbm
             return true;
         }
 
+        uint32_t hash = 0;
+        if (predt_memo_capacity != 0) {
+            hash = predt_hash(SUCCT, *this, bad, nullptr);
+            if (const predt_memo_t* memo = predt_find(hash, SUCCT, *this, bad, nullptr)) {
+                *this = predt_read(*memo, dim);
+                return memo->success;
+            }
+        }
+
+        // up(bad), computed once for all the good DBMs.
+        auto upBads = std::vector<dbm_t>{};
+        upBads.reserve(bad.size());
+        for (const auto& bads : bad) {
+            upBads.push_back(dbm::up(bads));
+        }
+
         fed_t result(getDimension());
+        bool success = true;
         for (const auto& goods : *this) {
             const_iterator bads = bad.begin(), bade = bad.end();
+            auto upBad = upBads.begin();
             dbm_t upGood = goods;
             upGood.up();
             auto intersec = fed_t{dim};
-            if (!dbm::succt(intersec, goods, upGood, *bads)) {
-                return false;
+            if (!dbm::succt(intersec, goods, upGood, *bads, *upBad)) {
+                success = false;
+                break;
             }
-            for (++bads; bads != bade && !intersec.isEmpty(); ++bads) {
+            for (++bads, ++upBad; bads != bade && !intersec.isEmpty(); ++bads, ++upBad) {
                 auto i = fed_t{dim};
-                if (!dbm::succt(i, goods, upGood, *bads)) {
-                    return false;
+                if (!dbm::succt(i, goods, upGood, *bads, *upBad)) {
+                    success = false;
+                    break;
                 }
                 intersec &= i;
             }
+            if (!success) {
+                break;
+            }
             result.steal(intersec);
         }
 
+        if (predt_memo_capacity != 0) {
+            predt_store(hash, SUCCT, *this, bad, nullptr, success ? result : fed_t(dim), success);
+        }
+        if (!success) {
+            return false;
+        }
         swap(result);
         return true;
     }
@@ -2960,11 +4111,17 @@ namespace dbm
             return true;
         } else if (good.isEmpty() || good.sameAs(bad)) {
             return false;
+        } else if (predt_memo_capacity != 0 && !bad.isEmpty()) {
+            // Use predt(good, bad) if it is known.
+            if (const predt_memo_t* memo =
+                    predt_find(predt_hash(PREDT, good, bad, nullptr), PREDT, good, bad, nullptr)) {
+                return le(predt_read(*memo, getDimension()));
+            }
         }
         // gooddies
         fed_t downGood = good;
         downGood.down();
-        bool ledg = *this <= downGood;  // le(downGood);
+        bool ledg = le(downGood);
         if (bad.isEmpty())              // then predt(good,bad) == down(good)
         {
             return ledg;
@@ -2988,7 +4145,7 @@ namespace dbm
 
             if (++bads != bad_e) {
                 // false for sure
-                if (!(*this <= result)) {  //(!le(result))
+                if (!le(result)) {
                     return false;
                 }
 
@@ -3008,7 +4165,7 @@ namespace dbm
                         fed.unionWith((goodAndDownBad -= *bads).down());
                     }
                     // false for sure
-                    if (!(*this <= fed)) {  // (!le(fed))
+                    if (!le(fed)) {
                         return false;
                     }
                     result &= fed;  // predt(good,union bad) = intersec predt(good,bad)
@@ -3028,6 +4185,9 @@ namespace dbm
             return false;
         } else if (arg.isEmpty()) {
             return true;
+        } else if (const FedIndex* index = fed_getIndex(ifed())) {
+            return fed_anyIntersecting(index, arg.const_dbm(), getDimension(),
+                                       [&](const dbm_t& dbm) { return dbm == arg; });
         } else {
             return std::find(begin(), end(), arg) != end();
         }
@@ -3040,6 +4200,8 @@ namespace dbm
 
         if (dim != getDimension()) {
             return false;
+        } else if (const FedIndex* index = fed_getIndex(ifed())) {
+            return fed_anyIntersecting(index, arg, dim, [&](const dbm_t& dbm) { return dbm == arg; });
         } else {
             return std::find(begin(), end(), arg) != end();
         }
@@ -3089,7 +4251,7 @@ namespace dbm
 
         bool argNotIncluded = true;
         for (iterator i = begin_mutable(), e = end_mutable(); i != e;) {
-            switch (dbm_relation(i->const_dbm(), arg, dim)) {
+            switch (i->hasDisjointBounds(arg, dim) ? base_DIFFERENT : dbm_relation(i->const_dbm(), arg, dim)) {
             case base_EQUAL:   // this dbm == arg
             case base_SUBSET:  // this dbm < arg
                 i.remove();
@@ -3138,7 +4300,11 @@ namespace dbm
             } else if (arg.size() == 1) {
                 return false;  // then we know the result
             } else {
-                return (fed_t(*this) -= arg).isEmpty();
+                fed_inclusion_t inclusion(*this, arg, fed_getIndex(arg.ifed()));
+                while (inclusion.isOpen()) {
+                    inclusion.next();
+                }
+                return inclusion.isIncluded();
             }
         }
     }
@@ -3170,7 +4336,7 @@ namespace dbm
         else if (fed.size() == 1) {
             return false;
         } else {  // not simple
-            return (fed_t(dbm_t(dbm, dim)) -= fed).isEmpty();
+            return fed_cover_t(fed, fed_getIndex(fed.ifed())).covers(dbm_t(dbm, dim));
         }
     }
 
@@ -3199,8 +4365,8 @@ namespace dbm
                     // arg2 is unconstrained => result = empty
                     return fed_t(dim);
                 } else {
-                    return fed_t(ifed_t::create(
-                        dim, internSubtract(fdbm_t::create(arg1, dim), arg2, dim, minDBM.data(), minSize, nb)));
+                    return fed_t(ifed_t::create(dim, internSubtract(fdbm_t::create(arg1, dim), arg2, dim, minDBM.data(),
+                                                                    minSize, nb, disjoint_subtraction)));
                 }
             }
             // arg1 - arg2 = arg1
@@ -3222,8 +4388,8 @@ namespace dbm
             size_t minSize = bits2intsize(dim * dim);
             size_t nb;
             const uint32_t* minDBM = arg2.getMinDBM(&nb);
-            return fed_t(
-                ifed_t::create(dim, internSubtract(fdbm_t::create(arg1), arg2.const_dbm(), dim, minDBM, minSize, nb)));
+            return fed_t(ifed_t::create(dim, internSubtract(fdbm_t::create(arg1), arg2.const_dbm(), dim, minDBM,
+                                                            minSize, nb, disjoint_subtraction)));
         } else {
             // arg1 - arg2 = arg1
             return fed_t(arg1);
@@ -3253,8 +4419,8 @@ namespace dbm
                     // arg2 is unconstrained => result = empty
                     return fed_t(dim);
                 } else {
-                    return fed_t(ifed_t::create(
-                        dim, internSubtract(fdbm_t::create(arg1), arg2, dim, minDBM.data(), minSize, nb)));
+                    return fed_t(ifed_t::create(dim, internSubtract(fdbm_t::create(arg1), arg2, dim, minDBM.data(),
+                                                                    minSize, nb, disjoint_subtraction)));
                 }
             }
             // arg1 - arg2 = arg1
@@ -3475,7 +4641,7 @@ namespace dbm
     // Implementation of subtraction of a DBM:
     // since we are going to subtract arg several times,
     // compute its minimal graph only once.
-    void fed_t::ptr_subtract(const raw_t* arg, cindex_t dim)
+    void fed_t::ptr_subtract(const raw_t* arg, cindex_t dim, bool disjoint)
     {
         assert(isOK());
         assert(dim == getDimension() && !isEmpty());
@@ -3486,17 +4652,31 @@ namespace dbm
         auto minDBM = std::vector<uint32_t>(minSize);
         size_t nb = 0;
         bool mingraph = false;  // Not computed.
+        subtraction_t strategy = SUBTRACT_MINGRAPH;
 
         if (dim <= 1) {
             ifed()->setEmpty();
         } else {
+            if (subtraction_pool && size() >= subtraction_threshold) {
+                // Every DBM intersects arg if its minimal graph is empty.
+                nb = dbm_cleanBitMatrix(arg, dim, minDBM.data(), dbm_analyzeForMinDBM(arg, dim, minDBM.data()));
+                if (nb == 0) {
+                    ifed()->setEmpty();
+                } else {
+                    dbmlist_t result =
+                        parallelSubtract(ifed()->head(), size(), arg, dim, minDBM.data(), minSize, nb, disjoint);
+                    ifed()->reset(result);
+                }
+                return;
+            }
             dbmlist_t result;
             fdbm_t *next, *current = ifed()->head();
             do {
                 next = current->getNext();
                 // Real test would be to compute the intersection and check
                 // it's not empty but that costs dim^3.
-                if (dbm_haveIntersection(current->dbmt().const_dbm(), arg, dim)) {
+                if (!current->const_dbmt().hasDisjointBounds(arg, dim) &&
+                    dbm_haveIntersection(current->dbmt().const_dbm(), arg, dim)) {
                     if (!mingraph)  // Then we need to compute it!
                     {
                         mingraph = true;  // Don't compute twice!
@@ -3507,9 +4687,11 @@ namespace dbm
                             ifed()->setEmpty();
                             return;
                         }
+                        strategy = fed_chooseSubtraction(dim, nb);  // once for all the DBMs
                     }
                     // current "disappears" in internSubtract
-                    dbmlist_t partial = internSubtract(current, arg, dim, minDBM.data(), minSize, nb);
+                    dbmlist_t partial =
+                        internSubtract(current, arg, dim, minDBM.data(), minSize, nb, strategy, disjoint);
                     result.unionWith(partial);
                 } else  // current - arg = current
                 {
@@ -3522,7 +4704,7 @@ namespace dbm
     }
 
 #ifdef ENABLE_STORE_MINGRAPH
-    void fed_t::ptr_subtract(const dbm_t& arg)
+    void fed_t::ptr_subtract(const dbm_t& arg, bool disjoint)
     {
         assert(isOK());
         assert(getDimension() == arg.getDimension());
@@ -3535,14 +4717,29 @@ namespace dbm
             ifed()->setEmpty();
         } else {
             size_t minSize = bits2intsize(dim * dim);
+            if (subtraction_pool && size() >= subtraction_threshold) {
+                size_t nb;
+                const uint32_t* minDBM = arg.getMinDBM(&nb);
+                dbmlist_t result =
+                    parallelSubtract(ifed()->head(), size(), arg.const_dbm(), dim, minDBM, minSize, nb, disjoint);
+                ifed()->reset(result);
+                return;
+            }
             dbmlist_t result;
             fdbm_t *next, *current = ifed()->head();
+            const uint32_t* minDBM = nullptr;  // Not computed.
+            size_t nb = 0;
+            subtraction_t strategy = SUBTRACT_MINGRAPH;
             do {
                 next = current->getNext();
-                if (dbm_haveIntersection(current->dbmt().const_dbm(), arg.const_dbm(), dim)) {
-                    size_t nb;
-                    const uint32_t* minDBM = arg.getMinDBM(&nb);  // skip cleanBitMatrix
-                    dbmlist_t partial = internSubtract(current, arg.const_dbm(), dim, minDBM, minSize, nb);
+                if (!current->const_dbmt().hasDisjointBounds(arg) &&
+                    dbm_haveIntersection(current->dbmt().const_dbm(), arg.const_dbm(), dim)) {
+                    if (minDBM == nullptr) {
+                        minDBM = arg.getMinDBM(&nb);  // skip cleanBitMatrix
+                        strategy = fed_chooseSubtraction(dim, nb);  // once for all the DBMs
+                    }
+                    dbmlist_t partial =
+                        internSubtract(current, arg.const_dbm(), dim, minDBM, minSize, nb, strategy, disjoint);
                     result.unionWith(partial);
                 } else  // current - arg = current
                 {
@@ -3562,9 +4759,9 @@ namespace dbm
     {
         RECORD_STAT();
         for (const auto& k : *this) {
-            const raw_t* dbm1 = k.const_dbm();
+            const raw_t* upper1 = k.getUpperBounds();
             for (cindex_t i = 1; i < dim; ++i)
-                if (dbm1[i * dim] <= dbm2[i * dim])
+                if (upper1[i] <= dbm2[i * dim])
                     goto next_k;
             RECORD_SUBSTAT("skip");
             return true;
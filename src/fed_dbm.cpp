@@ -85,6 +85,33 @@ namespace dbm
         return dim * dim - dim;
     }
 
+    // @return true if one of the constraints tightens dbm.
+    static bool dbm_tightens(const raw_t* dbm, cindex_t dim, const constraint_t* cnstr, size_t n)
+    {
+        for (size_t k = 0; k < n; ++k) {
+            assert(cnstr[k].i < dim && cnstr[k].j < dim);
+            if (dbm[cnstr[k].i * dim + cnstr[k].j] > cnstr[k].value) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Same with indirection.
+    static bool dbm_tightens(const raw_t* dbm, cindex_t dim, const cindex_t* table, const constraint_t* cnstr,
+                             size_t n)
+    {
+        for (size_t k = 0; k < n; ++k) {
+            cindex_t i = table[cnstr[k].i];
+            cindex_t j = table[cnstr[k].j];
+            assert(i < dim && j < dim);
+            if (dbm[i * dim + j] > cnstr[k].value) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     std::ostream& dbm_t::print(std::ostream& os, const ClockAccessor& access, bool full) const
     {
         if (isEmpty())
@@ -237,6 +264,7 @@ namespace dbm
             }
             dbm->link(entry);
             dbm_table.incBuckets();
+            dbm->getUpperBounds();  // immutable from now on
         }
     }
 
@@ -715,6 +743,10 @@ namespace dbm
     {
         const cindex_t dim = pdim();
         RECORD_STAT();
+        if (!dbm_tightens(const_dbm(), dim, cnstr, n)) {
+            RECORD_SUBSTAT("skip");  // unchanged, even if mutable
+            return true;
+        }
         if (tryMutable()) {
             RECORD_SUBSTAT("mutable");
             if (!dbm_constrainN(dbm(), dim, cnstr, n)) {
@@ -793,6 +825,10 @@ namespace dbm
         assert(table);
         RECORD_STAT();
         const cindex_t dim = pdim();
+        if (!dbm_tightens(const_dbm(), dim, table, cnstr, n)) {
+            RECORD_SUBSTAT("skip");  // unchanged, even if mutable
+            return true;
+        }
         if (tryMutable()) {
             RECORD_SUBSTAT("mutable");
             if (!dbm_constrainIndexedN(dbm(), dim, table, cnstr, n)) {
@@ -904,25 +940,27 @@ namespace dbm
     void dbm_t::ptr_up()
     {
         const cindex_t dim = pdim();
+        cindex_t i = 1;
+        auto cdbm = dbm_read();
         RECORD_STAT();
-        if (tryMutable()) {
+
+        // Check first if an update is necessary, otherwise even a
+        // mutable DBM keeps its minimal graph.
+        while (i < dim && cdbm.at(i, 0) == dbm_LS_INFINITY) {
+            ++i;
+        }
+        if (i == dim) {
+            RECORD_SUBSTAT("unchanged");
+        } else if (tryMutable()) {
             RECORD_SUBSTAT("mutable");
             dbm_up(dbm(), dim);  // mutable => write directly
         } else {
-            cindex_t i;
-            auto cdbm = dbm_read();
-            for (i = 1; i < dim; ++i) {
-                // if update is necessary
-                if (cdbm.at(i, 0) != dbm_LS_INFINITY) {
-                    RECORD_SUBSTAT("copy");
-                    // then update from where we are
-                    auto mdbm = icopy_write(dim);
-                    do {
-                        mdbm.at(i, 0) = dbm_LS_INFINITY;
-                    } while (++i < dim);
-                    break;
-                }
-            }
+            RECORD_SUBSTAT("copy");
+            // then update from where we are
+            auto mdbm = icopy_write(dim);
+            do {
+                mdbm.at(i, 0) = dbm_LS_INFINITY;
+            } while (++i < dim);
         }
     }
 
@@ -978,28 +1016,30 @@ namespace dbm
         assert(k > 0 && k < getDimension());
         RECORD_STAT();
         const cindex_t dim = pdim();
-        if (tryMutable()) {
+        cindex_t i = 0;
+        auto cdbm = dbm_read();
+
+        // Check first if an update is necessary, otherwise even a
+        // mutable DBM keeps its minimal graph.
+        while (i < dim && (i == k || (cdbm.at(k, i) == dbm_LS_INFINITY && cdbm.at(i, k) == cdbm.at(i, 0)))) {
+            ++i;
+        }
+        if (i == dim) {
+            RECORD_SUBSTAT("unchanged");
+        } else if (tryMutable()) {
             RECORD_SUBSTAT("mutable");
             dbm_freeClock(dbm(), dim, k);  // mutable => write directly
         } else {
-            cindex_t i;
-            auto cdbm = dbm_read();
-            for (i = 0; i < dim; ++i) {
-                // if update necessary
-                if (i != k && (cdbm.at(k, i) != dbm_LS_INFINITY || cdbm.at(i, k) != cdbm.at(i, 0))) {
-                    RECORD_SUBSTAT("copy");
-                    // then update with a mutable copy
-                    auto mdbm = icopy_write(dim);
-                    do {
-                        if (i != k) {
-                            mdbm.at(k, i) = dbm_LS_INFINITY;
-                            mdbm.at(i, k) = mdbm.at(i, 0);
-                        }
-                    } while (++i < dim);
-                    assertx(dbm_isValid(mdbm, dim));
-                    break;
+            RECORD_SUBSTAT("copy");
+            // then update with a mutable copy
+            auto mdbm = icopy_write(dim);
+            do {
+                if (i != k) {
+                    mdbm.at(k, i) = dbm_LS_INFINITY;
+                    mdbm.at(i, k) = mdbm.at(i, 0);
                 }
-            }
+            } while (++i < dim);
+            assertx(dbm_isValid(mdbm, dim));
         }
     }
 
@@ -1123,35 +1163,32 @@ namespace dbm
         assert(k > 0 && k < getDimension() && v >= 0 && v < dbm_INFINITY);
         RECORD_STAT();
         const cindex_t dim = pdim();
-        if (tryMutable()) {
+        cindex_t i = 0;
+        auto cdbm = dbm_read();
+        raw_t dk0 = dbm_bound2raw(v, dbm_WEAK);
+        raw_t d0k = dbm_bound2raw(-v, dbm_WEAK);
+
+        // Check first if an update is necessary, otherwise even a
+        // mutable DBM keeps its minimal graph.
+        while (i < dim && cdbm.at(k, i) == dbm_addFiniteRaw(dk0, cdbm.at(0, i)) &&
+               cdbm.at(i, k) == dbm_addRawFinite(cdbm.at(i, 0), d0k)) {
+            ++i;
+        }
+        if (i == dim) {
+            RECORD_SUBSTAT("unchanged");
+        } else if (tryMutable()) {
             RECORD_SUBSTAT("mutable");
             dbm_updateValue(dbm(), dim, k, v);
         } else {
-            cindex_t i = 0;
-            auto cdbm = dbm_read();
-            raw_t dk0 = dbm_bound2raw(v, dbm_WEAK);
-            raw_t d0k = dbm_bound2raw(-v, dbm_WEAK);
+            RECORD_SUBSTAT("copy");
+            // then update with a mutable copy from where we are
+            auto mdbm = icopy_write(dim);
             do {
-                // Updates for dbm[k,i] and dbm[i,k]
-                raw_t dki = dbm_addFiniteRaw(dk0, cdbm.at(0, i));
-                raw_t dik = dbm_addRawFinite(cdbm.at(i, 0), d0k);
-
-                // If updates are necessary
-                if (cdbm.at(k, i) != dki || cdbm.at(i, k) != dik) {
-                    RECORD_SUBSTAT("copy");
-                    // then update with a mutable copy
-                    auto mdbm = icopy_write(dim);
-                    mdbm.at(k, i) = dki;
-                    mdbm.at(i, k) = dik;
-                    while (++i < dim) {
-                        mdbm.at(k, i) = dbm_addFiniteRaw(dk0, mdbm.at(0, i));
-                        mdbm.at(i, k) = dbm_addRawFinite(mdbm.at(i, 0), d0k);
-                    }
-                    assert(mdbm.at(k, k) == dbm_LE_ZERO);
-                    assertx(dbm_isValid(mdbm, dim));
-                    break;
-                }
+                mdbm.at(k, i) = dbm_addFiniteRaw(dk0, mdbm.at(0, i));
+                mdbm.at(i, k) = dbm_addRawFinite(mdbm.at(i, 0), d0k);
             } while (++i < dim);
+            assert(mdbm.at(k, k) == dbm_LE_ZERO);
+            assertx(dbm_isValid(mdbm, dim));
         }
     }
 
@@ -1719,7 +1756,7 @@ namespace dbm
             return false;
         } else  // not simple
         {
-            return (fed_t(*this) -= fed).isEmpty();
+            return fed_t::isSubtractionEmpty(const_dbm(), pdim(), fed);
         }
     }
 }  // namespace dbm
@@ -21,6 +21,9 @@
 #include <base/bitstring.h>
 #include <debug/macros.h>
 
+#include <stdio.h>
+#include <stdlib.h>
+
 /**
  * @file
  * Miscellanous functions of the mingraph.h
@@ -36,6 +39,7 @@
 
 static void mingraph_convexUnion16(raw_t* dbm, const int32_t* minDBM, cindex_t dim);
 static void mingraph_convexUnion32(raw_t* dbm, const int32_t* minDBM, cindex_t dim);
+static void mingraph_convexUnionError(void);
 
 /***************************************************
  ********** Implementation of the API **************
@@ -134,6 +138,23 @@ size_t dbm_getSizeOfMinDBM(const int32_t* minDBM)
             cindex_t dim = mingraph_readDim(info);
             return headerAndConstraints + bits2intsize(dim * dim);
         }
+    } else if (mingraph_isCodedIJ(info)) /* delta */
+    {
+        size_t nbConstraints = mingraph_getNbConstraints(minDBM);
+        cindex_t dim = mingraph_readDim(info);
+
+        /* header + constraints + indices i*dim+j on 16 or 32 bits
+         */
+        return 1 + ((info & 0x00200000) >> 21) + ((nbConstraints + coded16) >> coded16) +
+               (mingraph_hasDeltaIndex16(dim) ? (nbConstraints + 1) >> 1 : nbConstraints);
+    } else if (mingraph_isDict(info)) {
+        /* header + references on 16 or 32 bits + literals on 1 or 2 ints
+         */
+        size_t nbRefs = mingraph_getDictNbRefs(minDBM);
+        size_t nbLits = mingraph_getDictNbLiterals(minDBM);
+        return (size_t)(mingraph_getDictRefs(minDBM) - minDBM) +
+               (mingraph_hasDictRef16(info) ? (nbRefs + 1) >> 1 : nbRefs) +
+               (mingraph_hasDictLiteral16(info) ? nbLits : 2 * nbLits);
     } else /* simply copy */
     {
         cindex_t dim = mingraph_readDim(info);
@@ -164,7 +185,9 @@ void dbm_convexUnionWithMinDBM(raw_t* dbm, cindex_t dim, const int32_t* minDBM,
     if (dim > 1) {
         uint32_t info = mingraph_getInfo(minDBM);
 
-        if (mingraph_isMinimal(info)) {
+        if (mingraph_isDict(info) || mingraph_isDelta(info)) {
+            mingraph_convexUnionError();
+        } else if (mingraph_isMinimal(info)) {
             /* avoid unpack for trivial DBMs
              */
             if (mingraph_getNbConstraints(minDBM)) {
@@ -192,8 +215,8 @@ representationOfMinDBM_t dbm_getRepresentationType(const int32_t* minDBM)
     static const representationOfMinDBM_t codeTypes[8] = {
         dbm_MINDBM_COPY32,      /* 0x00000000 copy, 32 bits                  */
         dbm_MINDBM_COPY16,      /* 0x00010000 copy, 16 bits                  */
-        dbm_MINDBM_ERROR,       /* 0x00020000 invalid                        */
-        dbm_MINDBM_ERROR,       /* 0x00030000 invalid                        */
+        dbm_MINDBM_DELTA32,     /* 0x00020000 delta against a base, 32 bits  */
+        dbm_MINDBM_DELTA16,     /* 0x00030000 delta against a base, 16 bits  */
         dbm_MINDBM_BITMATRIX32, /* 0x00040000 min. red. bit matrix, 32 bits  */
         dbm_MINDBM_BITMATRIX16, /* 0x00050000 min. red. bit matrix, 16 bits  */
         dbm_MINDBM_TUPLES32,    /* 0x00060000 min. red. couples i,j, 32 bits */
@@ -202,7 +225,9 @@ representationOfMinDBM_t dbm_getRepresentationType(const int32_t* minDBM)
 
     assert(minDBM && *minDBM);
 
-    return (*minDBM == 1) ? dbm_MINDBM_TRIVIAL : codeTypes[mingraph_getTypeIndexFromPtr(minDBM)];
+    return (*minDBM == 1)                           ? dbm_MINDBM_TRIVIAL
+           : mingraph_isDict(mingraph_getInfo(minDBM)) ? dbm_MINDBM_DICT
+                                                       : codeTypes[mingraph_getTypeIndexFromPtr(minDBM)];
 }
 
 /********************************************************
@@ -265,3 +290,13 @@ static void mingraph_convexUnion32(raw_t* dbm, const int32_t* minDBM, cindex_t d
         } while (--nbCols);
     } while (--nbLines);
 }
+
+/* Fatal error: delta formats need their base DBM, dictionary formats their dictionary.
+ */
+static void mingraph_convexUnionError(void)
+{
+    fprintf(stderr, RED(BOLD) UDBM_PACKAGE_STRING
+            " fatal error: cannot make the convex union with a delta or a dictionary mingraph without its base DBM or "
+            "its dictionary" NORMAL "\n");
+    exit(2);
+}
@@ -18,6 +18,7 @@
 #include "dbm/constraints.h"  // bit_t
 
 #include <base/bitstring.h>  // bit_t
+#include <base/c_allocator.h>
 
 #include <limits.h>
 
@@ -74,6 +75,28 @@ enum { dbm_INF16 = SHRT_MAX >> 1, dbm_LS_INF16 = dbm_INF16 << 1 };
  * Couple(i,j) data type:
  * int32_t[nsaved] or int16_t[nsaved] +
  * (i,j)of variable size * nsaved padded within int32_t
+ *
+ * Delta data type (0x00020000 set, 0x00040000 not set):
+ * int32_t[nsaved] or int16_t[nsaved] padded within int32_t +
+ * uint16_t[nsaved] padded within int32_t if dim <= 256,
+ * uint32_t[nsaved] otherwise. The constraints are those of the
+ * closed DBM that differ from the closed base DBM the delta was
+ * computed against and the indices are the i*dim+j positions
+ * of these constraints, in increasing order.
+ *
+ * Dictionary data type (copy 32 bits with 0x00080000 set, a bit
+ * the copy formats do not use), only readable with its dictionary:
+ * number of references nrefs and number of literals nlits, as
+ * uint32_t nrefs | (nlits << 16) if dim <= 256, uint32_t[2] otherwise +
+ * uint16_t[nrefs] padded within int32_t if 0x00100000 is set,
+ * uint32_t[nrefs] otherwise: indices of the constraints in the
+ * dictionary +
+ * constraints not in the dictionary, as uint32_t i*dim+j | (c_ij << 16)
+ * with c_ij on 16 bits if 0x00200000 is set (then dim <= 256),
+ * (uint32_t,int32_t) couples (i*dim+j, c_ij) otherwise.
+ * All together they are the constraints of the minimal graph.
+ * The generic functions do not know the dictionary and treat these
+ * mingraphs as invalid, see mingraph_getTypeIndex.
  ***************************************************************************/
 
 /* Basic information decoding from the type information.
@@ -86,17 +109,50 @@ static inline uint32_t mingraph_isMinimal(uint32_t info) { return 0x00040000 & i
 
 static inline uint32_t mingraph_isCodedIJ(uint32_t info) { return 0x00020000 & info; }
 
+static inline bool mingraph_isDelta(uint32_t info) { return (info & 0x00060000) == 0x00020000; }
+
+static inline bool mingraph_isDict(uint32_t info) { return (info & 0x000f0000) == 0x00080000; }
+
+static inline uint32_t mingraph_hasDictRef16(uint32_t info) { return 0x00100000 & info; }
+
+static inline uint32_t mingraph_hasDictLiteral16(uint32_t info) { return 0x00200000 & info; }
+
+/* Numbers of references and literals of dictionary mingraphs fit
+ * on 16 bits as long as dim*(dim-1) < 2^16.
+ */
+static inline bool mingraph_hasDictCounts16(cindex_t dim) { return dim <= 256; }
+
+static inline size_t mingraph_getDictNbRefs(const int32_t* mingraph)
+{
+    return mingraph_hasDictCounts16(0x0000ffff & mingraph[0]) ? (uint32_t)mingraph[1] & 0xffff : (uint32_t)mingraph[1];
+}
+
+static inline size_t mingraph_getDictNbLiterals(const int32_t* mingraph)
+{
+    return mingraph_hasDictCounts16(0x0000ffff & mingraph[0]) ? (uint32_t)mingraph[1] >> 16 : (uint32_t)mingraph[2];
+}
+
+/* @return the start of the references of a dictionary mingraph.
+ */
+static inline const int32_t* mingraph_getDictRefs(const int32_t* mingraph)
+{
+    return mingraph + (mingraph_hasDictCounts16(0x0000ffff & mingraph[0]) ? 2 : 3);
+}
+
+/* Indices of delta encodings fit on 16 bits as long as dim*dim <= 2^16.
+ */
+static inline bool mingraph_hasDeltaIndex16(cindex_t dim) { return dim <= 256; }
+
 /* We need to test types of the encoding
  * based on the bits
  * 0x00010000 codes if constraints are on 16 bits
  * 0x00020000 codes couples i,j
  * 0x00040000 marks if minimal reduction used
- * There are 6 valid combination out of 8
- * possible:
+ * All 8 combinations are valid:
  * 0x00000000 copy, 32 bits
  * 0x00010000 copy, 16 bits
- * 0x00020000 invalid
- * 0x00030000 invalid
+ * 0x00020000 delta against a base, 32 bits
+ * 0x00030000 delta against a base, 16 bits
  * 0x00040000 min. red. bit matrix, 32 bits
  * 0x00050000 min. red. bit matrix, 16 bits
  * 0x00060000 min. red. couples i,j, 32 bits
@@ -106,8 +162,15 @@ static inline uint32_t mingraph_isCodedIJ(uint32_t info) { return 0x00020000 & i
  * by making a jump to the right function
  * directly with the index being defined
  * as (info & 0x00070000) >> 16
+ * The dictionary mingraphs look like copies
+ * but need their dictionary, so they get the
+ * index of the deltas, whose functions in the
+ * tables only report errors.
  */
-static inline uint32_t mingraph_getTypeIndex(uint32_t info) { return (info & 0x00070000) >> 16; }
+static inline uint32_t mingraph_getTypeIndex(uint32_t info)
+{
+    return mingraph_isDict(info) ? 2 : (info & 0x00070000) >> 16;
+}
 
 /* Decode # of bits used for indices:
  * 0 -> 4 bits
@@ -150,7 +213,7 @@ static inline size_t mingraph_getNbConstraints(const int32_t* mingraph)
     return (mingraph[0] & 0x00200000) ? /* long format */
                (size_t)mingraph[1]
                                       :     /* next int    */
-               ((size_t)mingraph[0]) >> 22; /* higher bits */
+               ((size_t)(uint32_t)mingraph[0]) >> 22; /* higher bits, no sign extension */
 }
 
 /* Getting the coded data =
@@ -232,6 +295,33 @@ static inline const uint32_t* mingraph_jumpConstInt16(const int16_t* ints, size_
  */
 size_t dbm_cleanBitMatrix(const raw_t* dbm, cindex_t dim, uint32_t* bitMatrix, size_t nbConstraints);
 
+/* Possible encodings of a minimal graph for dim > 2. */
+typedef enum {
+    mingraph_ENCODE_COPY,
+    mingraph_ENCODE_BITMATRIX,
+    mingraph_ENCODE_COUPLESIJ,
+    mingraph_NB_ENCODINGS
+} mingraph_encoding_t;
+
+/* Sizes of the different encodings of a minimal graph.
+ * @param dim: dimension, > 2.
+ * @param cnt: number of constraints to save, > 0.
+ * @param constraints16: if the constraints are saved on 16 bits.
+ * @param sizes: where to write the sizes, a size_t[mingraph_NB_ENCODINGS].
+ * @param bitCode: where to write the code of the bits of couples i,j.
+ */
+void mingraph_getEncodingSizes(cindex_t dim, size_t cnt, bool constraints16, size_t* sizes, uint32_t* bitCode);
+
+/* Encode an analyzed DBM with a given encoding.
+ * @param dbm,dim: DBM of dimension dim > 2.
+ * @param bitMatrix,cnt: cleaned minimal graph with cnt > 0 constraints.
+ * @param constraints16: if the constraints fit on 16 bits.
+ * @param encoding: the encoding to use.
+ * @param c_alloc,offset: as for dbm_writeToMinDBMWithOffset.
+ */
+int32_t* mingraph_encodeAs(const raw_t* dbm, cindex_t dim, const uint32_t* bitMatrix, size_t cnt,
+                           bool constraints16, mingraph_encoding_t encoding, allocator_t c_alloc, size_t offset);
+
 /** Useful function for bit manipulation
  * return a negated bit and set it afterwards.
  * instead of having
@@ -254,6 +344,24 @@ static inline bit_t mingraph_ngetAndSetBit(uint32_t* bits, size_t index)
     return (bit_t)nbit;
 }
 
+/* Index of the lowest set bit, used to jump
+ * directly to the marked constraints of a bit matrix.
+ * @pre b != 0
+ */
+static inline uint32_t mingraph_lowestBit(uint32_t b)
+{
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_ctz(b);
+#else
+    uint32_t n = 0;
+    assert(b);
+    for (; (b & 1) == 0; b >>= 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
 /* In loops reading constraints i,j out of a bit matrix
  * j is incremented everytime a bit is skipped so it is
  * necessary to fix i and j. It seems that for higher
@@ -0,0 +1,299 @@
+/* -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/*********************************************************************
+ *
+ * Filename : mingraph_delta.c (dbm)
+ *
+ * Delta encoding of DBMs against a base DBM.
+ *
+ * This file is a part of the UPPAAL toolkit.
+ * Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+ * All right reserved.
+ *
+ *********************************************************************/
+
+#include "dbm.h"
+#include "mingraph_coding.h"
+
+#include "dbm/mingraph.h"
+
+#include <base/bitstring.h>
+#include <debug/macros.h>
+
+#include <stdlib.h>
+
+/**
+ * @file
+ * Contains the implementation of the delta format: only the
+ * constraints that differ from a base DBM are saved together with
+ * their indices i*dim+j, see mingraph_coding.h for the format.
+ */
+
+/* Size of the header for nb saved constraints, see
+ * the encoding of the number of constraints.
+ */
+static inline size_t mingraph_deltaHeaderSize(size_t nb) { return nb > 0x3ff ? 2 : 1; }
+
+/* Size in int32_t of the data of a delta with nb constraints.
+ */
+static inline size_t mingraph_deltaDataSize(size_t nb, cindex_t dim, uint32_t constraints16)
+{
+    return ((nb + constraints16) >> constraints16) + (mingraph_hasDeltaIndex16(dim) ? (nb + 1) >> 1 : nb);
+}
+
+/* Read the constraint number k of a delta.
+ * @param values: start of the saved constraints.
+ * @param coded16: if the constraints are on 16 bits.
+ */
+static inline raw_t mingraph_deltaConstraint(const int32_t* values, uint32_t coded16, size_t k)
+{
+    return coded16 ? mingraph_raw16to32(((const int16_t*)values)[k]) : values[k];
+}
+
+/* Read the index number k of a delta.
+ * @param indices: start of the saved indices.
+ * @param index16: if the indices are on 16 bits.
+ */
+static inline size_t mingraph_deltaIndex(const uint32_t* indices, bool index16, size_t k)
+{
+    return index16 ? ((const uint16_t*)indices)[k] : indices[k];
+}
+
+/* @return the start of the indices of a delta.
+ */
+static inline const uint32_t* mingraph_deltaIndices(const int32_t* values, uint32_t coded16, size_t nb)
+{
+    return coded16 ? mingraph_jumpConstInt16((const int16_t*)values, nb) : (const uint32_t*)(values + nb);
+}
+
+/* Count the constraints that differ from the base and
+ * compute their range at the same time.
+ * @param maxBits: where to accumulate the range.
+ * @return the number of differing constraints.
+ */
+static size_t mingraph_countDelta(const raw_t* dbm, const raw_t* baseDBM, cindex_t dim, raw_t* maxBits)
+{
+    size_t k, n = dim * dim, nb = 0;
+    raw_t bits = 0;
+
+    for (k = 0; k < n; ++k) {
+        if (dbm[k] != baseDBM[k]) {
+            ADD_BITS(bits, dbm[k]);
+            nb++;
+        }
+    }
+    *maxBits = bits;
+    return nb;
+}
+
+/*****************************
+ * Implementation of the API.
+ *****************************/
+
+size_t dbm_getSizeOfDeltaMinDBMFor(const raw_t* dbm, const raw_t* baseDBM, cindex_t dim, bool tryConstraints16)
+{
+    raw_t maxBits;
+    size_t nb;
+
+    assert(dbm && baseDBM && dim);
+
+    nb = mingraph_countDelta(dbm, baseDBM, dim, &maxBits);
+    return mingraph_deltaHeaderSize(nb) +
+           mingraph_deltaDataSize(nb, dim, (tryConstraints16 && maxBits < dbm_LS_INF16) ? 1 : 0);
+}
+
+/* Algorithm:
+ * - count the differing constraints and their range
+ * - allocate and write the header
+ * - write the constraints and then their indices
+ */
+int32_t* dbm_writeToDeltaMinDBMWithOffset(const raw_t* dbm, const raw_t* baseDBM, cindex_t dim,
+                                          bool tryConstraints16, allocator_t c_alloc, size_t offset)
+{
+    raw_t maxBits;
+    size_t k, n = dim * dim, nb, header;
+    uint32_t constraints16;
+    bool index16 = mingraph_hasDeltaIndex16(dim);
+    int32_t *mingraph, *values;
+    uint32_t* indices;
+
+    assert(dim <= 0xffff); /* fits on 16 bits */
+    assert(dbm && baseDBM && dim);
+    assert(c_alloc.allocFunction);
+    assert(!dbm_isEmpty(dbm, dim) && !dbm_isEmpty(baseDBM, dim));
+    assertx(dbm_isClosed(dbm, dim) && dbm_isClosed(baseDBM, dim));
+
+    nb = mingraph_countDelta(dbm, baseDBM, dim, &maxBits);
+    constraints16 = (tryConstraints16 && maxBits < dbm_LS_INF16) ? 1 : 0;
+    header = mingraph_deltaHeaderSize(nb);
+
+    mingraph = c_alloc.allocFunction(offset + header + mingraph_deltaDataSize(nb, dim, constraints16),
+                                     c_alloc.allocData);
+
+    /* info ; see encoding format */
+    if (header == 1) {
+        mingraph[offset] = (int32_t)(dim | (constraints16 << 16) | 0x00020000 | (nb << 22));
+    } else {
+        mingraph[offset] = (int32_t)(dim | (constraints16 << 16) | 0x00020000 | 0x00200000);
+        mingraph[offset + 1] = (int32_t)nb;
+    }
+    values = mingraph + offset + header;
+    indices = (uint32_t*)mingraph_deltaIndices(values, constraints16, nb);
+
+    /* padding, not to leave garbage
+     * in verbatim comparisons
+     */
+    if (constraints16 && (nb & 1)) {
+        ((int16_t*)values)[nb] = 0;
+    }
+    if (index16 && (nb & 1)) {
+        ((uint16_t*)indices)[nb] = 0;
+    }
+
+    if (nb) {
+        size_t i = 0;
+        for (k = 0; k < n; ++k) {
+            if (dbm[k] != baseDBM[k]) {
+                if (constraints16) {
+                    ((int16_t*)values)[i] = mingraph_raw32to16(dbm[k]);
+                } else {
+                    values[i] = dbm[k];
+                }
+                if (index16) {
+                    ((uint16_t*)indices)[i] = (uint16_t)k;
+                } else {
+                    indices[i] = (uint32_t)k;
+                }
+                i++;
+            }
+        }
+        assert(i == nb);
+    }
+
+    return mingraph;
+}
+
+bool dbm_isDeltaMinDBM(const int32_t* minDBM)
+{
+    assert(minDBM);
+    return mingraph_isDelta(mingraph_getInfo(minDBM));
+}
+
+cindex_t dbm_readFromDeltaMinDBM(raw_t* dbm, const raw_t* baseDBM, const int32_t* delta)
+{
+    uint32_t info = mingraph_getInfo(delta);
+    uint32_t coded16 = mingraph_isCoded16(info) >> 16;
+    cindex_t dim = mingraph_readDim(info);
+    size_t k, nb = mingraph_getNbConstraints(delta);
+    const int32_t* values = mingraph_getCodedData(delta);
+    const uint32_t* indices = mingraph_deltaIndices(values, coded16, nb);
+    bool index16 = mingraph_hasDeltaIndex16(dim);
+
+    assert(dbm && baseDBM && mingraph_isDelta(info));
+
+    if (dbm != baseDBM) {
+        dbm_copy(dbm, baseDBM, dim);
+    }
+    for (k = 0; k < nb; ++k) {
+        assert(mingraph_deltaIndex(indices, index16, k) < dim * dim);
+        dbm[mingraph_deltaIndex(indices, index16, k)] = mingraph_deltaConstraint(values, coded16, k);
+    }
+    assertx(dbm_isValid(dbm, dim));
+
+    return dim;
+}
+
+/* Algorithm: similar to dbm_relation but the constraints
+ * of the delta DBM are read from the delta for the saved
+ * indices and from the base otherwise.
+ */
+relation_t dbm_relationWithDeltaMinDBM(const raw_t* dbm, cindex_t dim, const raw_t* baseDBM, const int32_t* delta)
+{
+    uint32_t info = mingraph_getInfo(delta);
+    uint32_t coded16 = mingraph_isCoded16(info) >> 16;
+    size_t nb = mingraph_getNbConstraints(delta);
+    const int32_t* values = mingraph_getCodedData(delta);
+    const uint32_t* indices = mingraph_deltaIndices(values, coded16, nb);
+    bool index16 = mingraph_hasDeltaIndex16(dim);
+    size_t k = 0, n = dim * dim, next, i = 0;
+    bool subset = true, superset = true;
+
+    assert(dbm && baseDBM && mingraph_isDelta(info));
+    assert(mingraph_readDim(info) == dim);
+
+    do {
+        /* constraints up to the next saved index come from the base */
+        next = i < nb ? mingraph_deltaIndex(indices, index16, i) : n;
+        assert(next >= k && next <= n);
+        for (; k < next; ++k) {
+            subset &= dbm[k] <= baseDBM[k];
+            superset &= dbm[k] >= baseDBM[k];
+        }
+        if (!(subset | superset)) {
+            return base_DIFFERENT;
+        }
+        if (k < n) {
+            raw_t c = mingraph_deltaConstraint(values, coded16, i++);
+            subset &= dbm[k] <= c;
+            superset &= dbm[k] >= c;
+            k++;
+        }
+    } while (k < n);
+
+    return (relation_t)((subset ? base_SUBSET : 0) | (superset ? base_SUPERSET : 0));
+}
+
+/* Algorithm: analyze the DBM (needed anyway for the self-contained
+ * representation) and take the delta if it is not bigger than
+ * the constraints alone of the minimal graph.
+ */
+int32_t* dbm_writeToMinDBMRelativeTo(const raw_t* dbm, cindex_t dim, const raw_t* baseDBM, bool minimizeGraph,
+                                     bool tryConstraints16, allocator_t c_alloc, size_t offset)
+{
+    size_t deltaSize;
+    uint32_t constraints16;
+
+    assert(dbm && dim);
+
+    if (baseDBM == NULL || dim <= 2) {
+        return dbm_writeToMinDBMWithOffset(dbm, dim, minimizeGraph, tryConstraints16, c_alloc, offset);
+    }
+
+    deltaSize = dbm_getSizeOfDeltaMinDBMFor(dbm, baseDBM, dim, tryConstraints16);
+    constraints16 = (tryConstraints16 && dbm_getMaxRange(dbm, dim) < dbm_LS_INF16) ? 1 : 0;
+
+    if (minimizeGraph) {
+        uint32_t* bitMatrix = (uint32_t*)calloc(bits2intsize(dim * dim), sizeof(uint32_t));
+        size_t cnt = dbm_cleanBitMatrix(dbm, dim, bitMatrix, dbm_analyzeForMinDBM(dbm, dim, bitMatrix));
+        int32_t* mingraph;
+
+        if (deltaSize <= 1 + ((cnt + constraints16) >> constraints16)) {
+            mingraph = dbm_writeToDeltaMinDBMWithOffset(dbm, baseDBM, dim, tryConstraints16, c_alloc, offset);
+        } else {
+            mingraph = dbm_writeAnalyzedDBM(dbm, dim, bitMatrix, cnt, tryConstraints16, c_alloc, offset);
+        }
+        free(bitMatrix);
+        return mingraph;
+    } else if (deltaSize <= 1 + ((dim * (dim - 1) + constraints16) >> constraints16)) {
+        return dbm_writeToDeltaMinDBMWithOffset(dbm, baseDBM, dim, tryConstraints16, c_alloc, offset);
+    } else {
+        return dbm_writeToMinDBMWithOffset(dbm, dim, false, tryConstraints16, c_alloc, offset);
+    }
+}
+
+cindex_t dbm_readFromMinDBMRelativeTo(raw_t* dbm, const raw_t* baseDBM, const int32_t* minDBM)
+{
+    assert(minDBM);
+
+    return mingraph_isDelta(mingraph_getInfo(minDBM)) ? dbm_readFromDeltaMinDBM(dbm, baseDBM, minDBM)
+                                                      : dbm_readFromMinDBM(dbm, minDBM);
+}
+
+relation_t dbm_relationWithMinDBMRelativeTo(const raw_t* dbm, cindex_t dim, const raw_t* baseDBM,
+                                            const int32_t* minDBM, raw_t* unpackBuffer)
+{
+    assert(minDBM);
+
+    return mingraph_isDelta(mingraph_getInfo(minDBM))
+               ? dbm_relationWithDeltaMinDBM(dbm, dim, baseDBM, minDBM)
+               : dbm_relationWithMinDBM(dbm, dim, minDBM, unpackBuffer);
+}
@@ -0,0 +1,306 @@
+/* -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/*********************************************************************
+ *
+ * Filename : mingraph_dict.cpp (dbm)
+ *
+ * Dictionary encoding of minimal graphs.
+ *
+ * This file is a part of the UPPAAL toolkit.
+ * Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+ * All right reserved.
+ *
+ *********************************************************************/
+
+#include "dbm.h"
+#include "mingraph_coding.h"
+
+#include "dbm/mingraph.h"
+
+#include <base/bitstring.h>
+#include <debug/macros.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/* Maximal number of constraints counted before they enter the
+ * dictionary, can be redefined to anything > 0. When it is reached
+ * the counters are reset so that rare constraints do not accumulate.
+ */
+#ifndef MINGRAPH_DICT_CANDIDATES
+#define MINGRAPH_DICT_CANDIDATES 65536
+#endif
+
+/* Dictionary of constraints (i*dim+j, c_ij) */
+struct mingraph_dict_s
+{
+    explicit mingraph_dict_s(uint32_t t): threshold(t) {}
+
+    /* Key of a constraint */
+    static uint64_t key(size_t k, raw_t c) { return (((uint64_t)k) << 32) | (uint32_t)c; }
+
+    /* @return the index of the constraint in the dictionary,
+     * after adding it if it was seen often enough, or ~0.
+     */
+    uint32_t learn(size_t k, raw_t c)
+    {
+        uint64_t kc = key(k, c);
+        auto it = index.find(kc);
+        if (it != index.end()) {
+            return it->second;
+        }
+        if (candidates.size() >= MINGRAPH_DICT_CANDIDATES) {
+            candidates.clear();
+        }
+        if (++candidates[kc] < threshold || entries.size() == UINT32_MAX) {
+            return ~0u;
+        }
+        candidates.erase(kc);
+        uint32_t i = (uint32_t)entries.size();
+        entries.emplace_back((uint32_t)k, c);
+        index.emplace(kc, i);
+        return i;
+    }
+
+    uint32_t threshold;
+    std::vector<std::pair<uint32_t, raw_t>> entries; /* index -> constraint        */
+    std::unordered_map<uint64_t, uint32_t> index;    /* constraint -> index        */
+    std::unordered_map<uint64_t, uint32_t> candidates; /* constraint -> occurrences */
+};
+
+/* Read the reference number r of a dictionary mingraph.
+ */
+static inline uint32_t mingraph_dictRef(const int32_t* refs, uint32_t ref16, size_t r)
+{
+    return ref16 ? ((const uint16_t*)refs)[r] : ((const uint32_t*)refs)[r];
+}
+
+/* @return the start of the literals of a dictionary mingraph.
+ */
+static inline const int32_t* mingraph_dictLiterals(const int32_t* refs, uint32_t ref16, size_t nbRefs)
+{
+    return ref16 ? refs + ((nbRefs + 1) >> 1) : refs + nbRefs;
+}
+
+/* Read the literal number l of a dictionary mingraph as (i*dim+j, c_ij).
+ */
+static inline std::pair<uint32_t, raw_t> mingraph_dictLiteral(const int32_t* literals, uint32_t lit16, size_t l)
+{
+    if (lit16) {
+        uint32_t literal = (uint32_t)literals[l];
+        return {literal & 0xffff, mingraph_finite16to32((int16_t)(literal >> 16))};
+    }
+    return {(uint32_t)literals[2 * l], literals[2 * l + 1]};
+}
+
+/* Write one constraint while unpacking, see readFromMinCouplesij32
+ * for the clocks to mark as touched.
+ */
+static inline void mingraph_dictSet(raw_t* dbm, cindex_t dim, size_t k, raw_t c, uint32_t* touched)
+{
+    assert(k < dim * dim);
+    dbm[k] = c;
+    if (k >= dim) {
+        base_setOneBit(touched, (cindex_t)(k / dim));
+        base_setOneBit(touched, (cindex_t)(k % dim));
+    }
+}
+
+/*****************************
+ * Implementation of the API.
+ *****************************/
+
+mingraph_dict_t* dbm_newMinDBMDict(uint32_t threshold)
+{
+    assert(threshold > 0);
+    return new mingraph_dict_s(threshold);
+}
+
+void dbm_deleteMinDBMDict(mingraph_dict_t* dict) { delete dict; }
+
+size_t dbm_getNbEntriesOfMinDBMDict(const mingraph_dict_t* dict)
+{
+    assert(dict);
+    return dict->entries.size();
+}
+
+/* Algorithm:
+ * - analyze the DBM
+ * - sort the constraints of the minimal graph into references
+ *   and literals while the dictionary learns them
+ * - if that is not smaller than the usual encoding, use it
+ * - otherwise allocate and write
+ */
+int32_t* dbm_writeToDictMinDBMWithOffset(mingraph_dict_t* dict, const raw_t* dbm, cindex_t dim,
+                                         allocator_t c_alloc, size_t offset)
+{
+    assert(dict && dbm && dim);
+    assert(dim <= 0xffff); /* fits on 16 bits */
+
+    if (dim <= 2) {
+        return dbm_writeToMinDBMWithOffset(dbm, dim, true, true, c_alloc, offset);
+    }
+
+    size_t n = dim * dim;
+    std::vector<uint32_t> bitMatrix(bits2intsize(n));
+    size_t cnt = dbm_cleanBitMatrix(dbm, dim, bitMatrix.data(), dbm_analyzeForMinDBM(dbm, dim, bitMatrix.data()));
+    std::vector<uint32_t> refs, literals;
+    uint32_t maxRef = 0;
+    bool lit16 = mingraph_hasDictCounts16(dim); /* indices fit on 16 bits */
+
+    refs.reserve(cnt);
+    literals.reserve(cnt);
+    for (size_t k = 0, w = 0; k < n; k += 32, ++w) {
+        for (uint32_t b = bitMatrix[w]; b != 0; b &= b - 1) {
+            size_t kb = k + mingraph_lowestBit(b);
+            uint32_t r = dict->learn(kb, dbm[kb]);
+            if (~r) {
+                refs.push_back(r);
+                maxRef |= r;
+            } else {
+                literals.push_back((uint32_t)kb);
+                lit16 = lit16 && dbm[kb] < dbm_LS_INF16 && -dbm[kb] < dbm_LS_INF16;
+            }
+        }
+    }
+    assert(refs.size() + literals.size() == cnt);
+
+    /* the usual encoding when it is not bigger */
+    size_t usualSize = 1; /* no constraint */
+    if (cnt != 0) {
+        size_t sizes[mingraph_NB_ENCODINGS];
+        uint32_t bitCode;
+        mingraph_getEncodingSizes(dim, cnt, dbm_getMaxRange(dbm, dim) < dbm_LS_INF16, sizes, &bitCode);
+        usualSize = *std::min_element(sizes, sizes + mingraph_NB_ENCODINGS);
+    }
+    uint32_t ref16 = maxRef <= 0xffff ? 1 : 0;
+    size_t nbRefs = refs.size(), nbLits = literals.size();
+    size_t header = mingraph_hasDictCounts16(dim) ? 2 : 3;
+    size_t size = header + (ref16 ? (nbRefs + 1) >> 1 : nbRefs) + (lit16 ? nbLits : 2 * nbLits);
+    if (size >= usualSize) {
+        int32_t* mingraph = dbm_writeAnalyzedDBM(dbm, dim, bitMatrix.data(), cnt, true, c_alloc, offset);
+        assert(dbm_getSizeOfMinDBM(mingraph + offset) == usualSize);
+        return mingraph;
+    }
+
+    int32_t* mingraph = c_alloc.allocFunction(offset + size, c_alloc.allocData);
+    int32_t* where = mingraph + offset;
+
+    where[0] = (int32_t)(dim | 0x00080000 | (ref16 << 20) | (lit16 ? 0x00200000 : 0));
+    if (header == 2) {
+        where[1] = (int32_t)(nbRefs | (nbLits << 16));
+    } else {
+        where[1] = (int32_t)nbRefs;
+        where[2] = (int32_t)nbLits;
+    }
+    where += header;
+    if (ref16) {
+        uint16_t* refs16 = (uint16_t*)where;
+        for (size_t r = 0; r < nbRefs; ++r) {
+            refs16[r] = (uint16_t)refs[r];
+        }
+        if (nbRefs & 1) {
+            refs16[nbRefs] = 0; /* padding */
+        }
+        where += (nbRefs + 1) >> 1;
+    } else {
+        std::copy(refs.begin(), refs.end(), (uint32_t*)where);
+        where += nbRefs;
+    }
+    for (uint32_t k : literals) {
+        if (lit16) {
+            *where++ = (int32_t)(k | ((uint32_t)(uint16_t)mingraph_raw32to16(dbm[k]) << 16));
+        } else {
+            *where++ = (int32_t)k;
+            *where++ = dbm[k];
+        }
+    }
+    assert((size_t)(where - mingraph) - offset == size);
+    assert(dbm_getSizeOfMinDBM(mingraph + offset) == size);
+
+    return mingraph;
+}
+
+bool dbm_isDictMinDBM(const int32_t* minDBM)
+{
+    assert(minDBM);
+    return mingraph_isDict(mingraph_getInfo(minDBM));
+}
+
+cindex_t dbm_readFromDictMinDBM(const mingraph_dict_t* dict, raw_t* dbm, const int32_t* minDBM)
+{
+    uint32_t info = mingraph_getInfo(minDBM);
+
+    assert(dict && dbm);
+
+    if (!mingraph_isDict(info)) {
+        return dbm_readFromMinDBM(dbm, minDBM);
+    }
+
+    cindex_t dim = mingraph_readDim(info);
+    uint32_t ref16 = mingraph_hasDictRef16(info), lit16 = mingraph_hasDictLiteral16(info);
+    size_t nbRefs = mingraph_getDictNbRefs(minDBM), nbLits = mingraph_getDictNbLiterals(minDBM);
+    const int32_t* refs = mingraph_getDictRefs(minDBM);
+    const int32_t* literals = mingraph_dictLiterals(refs, ref16, nbRefs);
+    std::vector<uint32_t> touched(bits2intsize(dim));
+
+    dbm_init(dbm, dim);
+    for (size_t r = 0; r < nbRefs; ++r) {
+        const auto& entry = dict->entries[mingraph_dictRef(refs, ref16, r)];
+        mingraph_dictSet(dbm, dim, entry.first, entry.second, touched.data());
+    }
+    for (size_t l = 0; l < nbLits; ++l) {
+        auto literal = mingraph_dictLiteral(literals, lit16, l);
+        mingraph_dictSet(dbm, dim, literal.first, literal.second, touched.data());
+    }
+    dbm_closex(dbm, dim, touched.data());
+    assertx(dbm_isValid(dbm, dim));
+
+    return dim;
+}
+
+/* Algorithm: the DBM of minDBM is the closure of its minimal
+ * graph so dbm is included in it iff dbm satisfies all the
+ * constraints of the minimal graph. The exact relation needs
+ * to unpack.
+ */
+relation_t dbm_relationWithDictMinDBM(const mingraph_dict_t* dict, const raw_t* dbm, cindex_t dim,
+                                      const int32_t* minDBM, raw_t* unpackBuffer)
+{
+    uint32_t info = mingraph_getInfo(minDBM);
+
+    assert(dict && dbm && dim);
+    assert(dbm_isClosed(dbm, dim));
+
+    if (!mingraph_isDict(info)) {
+        return dbm_relationWithMinDBM(dbm, dim, minDBM, unpackBuffer);
+    }
+    if (mingraph_readDim(info) != dim) {
+        return base_DIFFERENT;
+    }
+    if (unpackBuffer) {
+        dbm_readFromDictMinDBM(dict, unpackBuffer, minDBM);
+        return dbm_relation(dbm, unpackBuffer, dim);
+    }
+
+    uint32_t ref16 = mingraph_hasDictRef16(info), lit16 = mingraph_hasDictLiteral16(info);
+    size_t nbRefs = mingraph_getDictNbRefs(minDBM), nbLits = mingraph_getDictNbLiterals(minDBM);
+    const int32_t* refs = mingraph_getDictRefs(minDBM);
+    const int32_t* literals = mingraph_dictLiterals(refs, ref16, nbRefs);
+
+    for (size_t r = 0; r < nbRefs; ++r) {
+        const auto& entry = dict->entries[mingraph_dictRef(refs, ref16, r)];
+        if (dbm[entry.first] > entry.second) {
+            return base_DIFFERENT;
+        }
+    }
+    for (size_t l = 0; l < nbLits; ++l) {
+        auto literal = mingraph_dictLiteral(literals, lit16, l);
+        if (dbm[literal.first] > literal.second) {
+            return base_DIFFERENT;
+        }
+    }
+    return base_SUBSET;
+}
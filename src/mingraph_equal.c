@@ -38,6 +38,7 @@ static bool mingraph_isEqualToMinBitMatrix16(const raw_t* dbm, cindex_t dim, con
 static bool mingraph_isEqualToMinCouplesij32(const raw_t* dbm, cindex_t dim, const int32_t* mingraph);
 static bool mingraph_isEqualToMinCouplesij16(const raw_t* dbm, cindex_t dim, const int32_t* mingraph);
 static bool mingraph_isEqualError(const raw_t* dbm, cindex_t dim, const int32_t* mingraph);
+static bool mingraph_isUnpackedEqualError(void);
 
 /************************************
  * Equality tests with pre-analysis *
@@ -128,7 +129,9 @@ bool dbm_isUnpackedEqualToMinDBM(const raw_t* dbm, cindex_t dim, const int32_t*
 {
     uint32_t info = mingraph_getInfo(minDBM);
 
-    if (mingraph_isMinimal(info)) {
+    if (mingraph_isDict(info) || mingraph_isDelta(info)) {
+        return mingraph_isUnpackedEqualError();
+    } else if (mingraph_isMinimal(info)) {
         dbm_readFromMinDBM(unpackBuffer, minDBM);
         return dbm_areEqual(dbm, unpackBuffer, dim);
     } else {
@@ -560,3 +563,14 @@ static bool mingraph_isAnalyzedDBMEqualError(const raw_t* dbm, cindex_t dim, uin
     exit(2);
     return false; /* compiler happy */
 }
+
+/* Fatal error: delta formats need their base DBM, dictionary formats their dictionary.
+ */
+static bool mingraph_isUnpackedEqualError(void)
+{
+    fprintf(stderr, RED(BOLD) UDBM_PACKAGE_STRING
+            " fatal error: cannot compare with a delta or a dictionary mingraph without its base DBM or its "
+            "dictionary" NORMAL "\n");
+    exit(2);
+    return false; /* compiler happy */
+}
@@ -0,0 +1,264 @@
+/* -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/*********************************************************************
+ *
+ * Filename : mingraph_hash.c (dbm)
+ *
+ * Canonical hash of minimal graphs.
+ *
+ * This file is a part of the UPPAAL toolkit.
+ * Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+ * All right reserved.
+ *
+ *********************************************************************/
+
+#include "dbm.h"
+#include "mingraph_coding.h"
+
+#include "dbm/mingraph.h"
+
+#include <base/bitstring.h>
+#include <debug/macros.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @file
+ * Contains the implementation of the canonical hash of the
+ * minimal graph of a DBM. Every constraint (i,j,c) of the minimal
+ * graph contributes hash(i*dim+j, c) and the contributions are
+ * added, so that the order in which the constraints are decoded
+ * does not matter. This gives the same value for all encodings
+ * of the same DBM, see dbm_hashOfMinDBM.
+ */
+
+/* Contribution of one constraint of the minimal graph.
+ * @param k: index i*dim+j of the constraint.
+ * @param c: the constraint.
+ * @param dim: dimension, used as seed.
+ */
+static inline uint32_t mingraph_hashConstraint(size_t k, raw_t c, cindex_t dim)
+{
+    uint32_t data[2];
+    data[0] = (uint32_t)k;
+    data[1] = (uint32_t)c;
+    return hash_computeU32(data, 2, dim);
+}
+
+/* Final mix of the accumulated contributions.
+ * @param sum: sum of the contributions.
+ * @param nb: number of constraints.
+ * @param dim: dimension.
+ */
+static inline uint32_t mingraph_hashFinish(uint32_t sum, size_t nb, cindex_t dim)
+{
+    uint32_t data[2];
+    data[0] = sum;
+    data[1] = (uint32_t)nb;
+    return hash_computeU32(data, 2, dim);
+}
+
+/* Constraints x>=0 are not saved, see dbm_cleanBitMatrix.
+ */
+static inline bool mingraph_isCleanedConstraint(size_t k, raw_t c, cindex_t dim)
+{
+    return CLOCKS_POSITIVE && k < dim && c >= dbm_LE_ZERO;
+}
+
+/* Type of hash functions on the different formats.
+ * The buffer is a raw_t[dim*dim] for the formats that
+ * need to be unpacked.
+ */
+typedef uint32_t (*hashDBM_f)(const int32_t*, raw_t*);
+
+/* Hash of the formats that do not store the minimal graph:
+ * unpack and analyze.
+ */
+static uint32_t mingraph_hashOfCopy(const int32_t* mingraph, raw_t* buffer)
+{
+    cindex_t dim = dbm_readFromMinDBM(buffer, mingraph);
+    uint32_t* bitMatrix = (uint32_t*)calloc(bits2intsize(dim * dim), sizeof(uint32_t));
+    uint32_t hashValue;
+
+    dbm_analyzeForMinDBM(buffer, dim, bitMatrix);
+    hashValue = dbm_hashOfAnalyzedDBM(buffer, dim, bitMatrix);
+    free(bitMatrix);
+    return hashValue;
+}
+
+/* Hash of the format minimal graph with bit matrix,
+ * constraints on 32 bits.
+ */
+static uint32_t mingraph_hashOfMinBitMatrix32(const int32_t* mingraph, raw_t* buffer)
+{
+    cindex_t dim = mingraph_readDimFromPtr(mingraph);
+    size_t nb = mingraph_getNbConstraints(mingraph);
+    const raw_t* constraints = mingraph_getCodedData(mingraph);
+    const uint32_t* bitMatrix = (const uint32_t*)&constraints[nb];
+    size_t k, n = dim * dim, count = nb;
+    uint32_t sum = 0;
+
+    assert(base_countBitsN(bitMatrix, bits2intsize(n)) == nb);
+
+    for (k = 0; count != 0; k += 32, ++bitMatrix) {
+        uint32_t b;
+        size_t kb = k;
+        assert(k < n);
+        for (b = *bitMatrix; b != 0; ++kb, b >>= 1) {
+            for (; (b & 1) == 0; ++kb, b >>= 1)
+                ;
+            sum += mingraph_hashConstraint(kb, *constraints++, dim);
+            count--;
+        }
+    }
+    return mingraph_hashFinish(sum, nb, dim);
+}
+
+/* Hash of the format minimal graph with bit matrix,
+ * constraints on 16 bits.
+ */
+static uint32_t mingraph_hashOfMinBitMatrix16(const int32_t* mingraph, raw_t* buffer)
+{
+    cindex_t dim = mingraph_readDimFromPtr(mingraph);
+    size_t nb = mingraph_getNbConstraints(mingraph);
+    const int16_t* constraints = (const int16_t*)mingraph_getCodedData(mingraph);
+    const uint32_t* bitMatrix = mingraph_jumpConstInt16(constraints, nb);
+    size_t k, n = dim * dim, count = nb;
+    uint32_t sum = 0;
+
+    assert(base_countBitsN(bitMatrix, bits2intsize(n)) == nb);
+
+    for (k = 0; count != 0; k += 32, ++bitMatrix) {
+        uint32_t b;
+        size_t kb = k;
+        assert(k < n);
+        for (b = *bitMatrix; b != 0; ++kb, b >>= 1) {
+            for (; (b & 1) == 0; ++kb, b >>= 1)
+                ;
+            sum += mingraph_hashConstraint(kb, mingraph_finite16to32(*constraints++), dim);
+            count--;
+        }
+    }
+    return mingraph_hashFinish(sum, nb, dim);
+}
+
+/* Hash of the format minimal graph with couples (i,j),
+ * constraints on 32 or 16 bits.
+ * @param coded16: if the constraints are on 16 bits.
+ */
+static inline uint32_t mingraph_hashOfMinCouplesij(const int32_t* mingraph, raw_t* buffer, bool coded16)
+{
+    uint32_t info = mingraph_getInfo(mingraph);
+    cindex_t dim = mingraph_readDim(info);
+    size_t nb = mingraph_getNbConstraints(mingraph);
+    const int32_t* constraints = mingraph_getCodedData(mingraph);
+    const uint32_t* couplesij;
+    uint32_t bitSize, bitMask, consumed = 0, val_ij, sum = 0;
+    size_t k;
+
+    /* Init DBMs are saved without constraint whether or not the
+     * constraints x>=0 are part of the minimal graph: analyze.
+     */
+    if (nb == 0) {
+        return mingraph_hashOfCopy(mingraph, buffer);
+    }
+
+    /* reminder: size of indices of couples i,j = 4, 8, or 16 bits,
+     * see mingraph_typeOfIJ
+     */
+    bitSize = (uint32_t)(1 << (mingraph_typeOfIJ(info) + 2));
+    bitMask = (uint32_t)((1 << bitSize) - 1);
+    couplesij = coded16 ? mingraph_jumpConstInt16((const int16_t*)constraints, nb)
+                        : (const uint32_t*)&constraints[nb];
+    val_ij = *couplesij;
+
+    for (k = 0;;) {
+        cindex_t i, j;
+        raw_t c = coded16 ? mingraph_finite16to32(((const int16_t*)constraints)[k]) : constraints[k];
+
+        i = val_ij & bitMask;
+        val_ij >>= bitSize;
+        j = val_ij & bitMask;
+        val_ij >>= bitSize;
+        consumed += bitSize + bitSize;
+        assert(i < dim && j < dim);
+
+        sum += mingraph_hashConstraint(i * dim + j, c, dim);
+
+        if (++k == nb) {
+            return mingraph_hashFinish(sum, nb, dim);
+        }
+        assert(consumed <= 32);
+        if (consumed == 32) {
+            consumed = 0;
+            val_ij = *++couplesij;
+        }
+    }
+}
+
+static uint32_t mingraph_hashOfMinCouplesij32(const int32_t* mingraph, raw_t* buffer)
+{
+    return mingraph_hashOfMinCouplesij(mingraph, buffer, false);
+}
+
+static uint32_t mingraph_hashOfMinCouplesij16(const int32_t* mingraph, raw_t* buffer)
+{
+    return mingraph_hashOfMinCouplesij(mingraph, buffer, true);
+}
+
+/* Delta formats need their base DBM, dictionary formats their dictionary.
+ */
+static uint32_t mingraph_hashError(const int32_t* mingraph, raw_t* buffer)
+{
+    fprintf(stderr, RED(BOLD) UDBM_PACKAGE_STRING
+            " fatal error: cannot hash a delta or a dictionary mingraph without its base DBM or its dictionary" NORMAL
+            "\n");
+    exit(2);
+    return 0; /* compiler happy */
+}
+
+/*****************************
+ * Implementation of the API.
+ *****************************/
+
+uint32_t dbm_hashOfAnalyzedDBM(const raw_t* dbm, cindex_t dim, const uint32_t* bitMatrix)
+{
+    size_t k, n = dim * dim, nb = 0;
+    uint32_t sum = 0;
+
+    assert(dbm && dim && bitMatrix);
+
+    for (k = 0; k < n; k += 32, ++bitMatrix) {
+        uint32_t b;
+        size_t kb = k;
+        for (b = *bitMatrix; b != 0; ++kb, b >>= 1) {
+            for (; (b & 1) == 0; ++kb, b >>= 1)
+                ;
+            assert(kb < n);
+            if (!mingraph_isCleanedConstraint(kb, dbm[kb], dim)) {
+                sum += mingraph_hashConstraint(kb, dbm[kb], dim);
+                nb++;
+            }
+        }
+    }
+    return mingraph_hashFinish(sum, nb, dim);
+}
+
+uint32_t dbm_hashOfMinDBM(const int32_t* minDBM, raw_t* buffer)
+{
+    /* see mingraph_getTypeIndex comments
+     */
+    static const hashDBM_f hashOf[8] = {mingraph_hashOfCopy,
+                                        mingraph_hashOfCopy,
+                                        mingraph_hashError,
+                                        mingraph_hashError,
+                                        mingraph_hashOfMinBitMatrix32,
+                                        mingraph_hashOfMinBitMatrix16,
+                                        mingraph_hashOfMinCouplesij32,
+                                        mingraph_hashOfMinCouplesij16};
+
+    assert(minDBM && *minDBM);
+
+    return (*minDBM == 1) ? mingraph_hashFinish(0, 0, 1) /* trivial case */
+                          : hashOf[mingraph_getTypeIndexFromPtr(minDBM)](minDBM, buffer);
+}
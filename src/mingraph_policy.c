@@ -0,0 +1,305 @@
+/* -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/*********************************************************************
+ *
+ * Filename : mingraph_policy.c (dbm)
+ *
+ * Encoding policies of minimal graphs.
+ *
+ * This file is a part of the UPPAAL toolkit.
+ * Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+ * All right reserved.
+ *
+ *********************************************************************/
+
+#include "dbm.h"
+#include "mingraph_coding.h"
+
+#include "dbm/mingraph.h"
+
+#include <base/bitstring.h>
+#include <debug/macros.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @file
+ * Contains the implementation of the encoding policies. The read
+ * cost of an encoding is modelled as the number of constraints
+ * dbm_relationWithMinDBM reads times a cost per constraint that
+ * is measured on the DBMs written, separately for every dimension.
+ */
+
+/* Number of DBMs measured per dimension before the policy
+ * relies on the measured costs only, can be redefined to
+ * anything > 0.
+ */
+#ifndef MINGRAPH_POLICY_SAMPLES
+#define MINGRAPH_POLICY_SAMPLES 16
+#endif
+
+/* Number of relations timed per DBM and encoding, the
+ * resolution of the timer is too coarse for one relation.
+ */
+#ifndef MINGRAPH_POLICY_REPEATS
+#define MINGRAPH_POLICY_REPEATS 256
+#endif
+
+/* Measures of one dimension */
+typedef struct
+{
+    statsOfMinDBMPolicy_t stats;
+    double time[mingraph_NB_ENCODINGS];  /* total measured time in ns      */
+    double reads[mingraph_NB_ENCODINGS]; /* total number of constraints read */
+} mingraph_dimPolicy_t;
+
+struct mingraph_policy_s
+{
+    objectiveOfMinDBM_t objective;
+    double speedWeight;
+    mingraph_dimPolicy_t* dims; /* indexed by dimension */
+    cindex_t nbDims;
+};
+
+/* Number of constraints read by dbm_relationWithMinDBM for
+ * the different encodings, in the worst case (inclusion).
+ * @param reads: where to write, a double[mingraph_NB_ENCODINGS].
+ */
+static void mingraph_getReads(cindex_t dim, size_t cnt, double* reads)
+{
+    reads[mingraph_ENCODE_COPY] = (double)(dim * (dim - 1));
+    reads[mingraph_ENCODE_BITMATRIX] = (double)(cnt + bits2intsize(dim * dim));
+    reads[mingraph_ENCODE_COUPLESIJ] = (double)cnt;
+}
+
+/* @return the measures for a dimension, allocated on demand.
+ */
+static mingraph_dimPolicy_t* mingraph_getDimPolicy(mingraph_policy_t* policy, cindex_t dim)
+{
+    if (dim >= policy->nbDims) {
+        mingraph_dimPolicy_t* dims =
+            (mingraph_dimPolicy_t*)realloc(policy->dims, (dim + 1) * sizeof(mingraph_dimPolicy_t));
+        assert(dims);
+        memset(dims + policy->nbDims, 0, (dim + 1 - policy->nbDims) * sizeof(mingraph_dimPolicy_t));
+        policy->dims = dims;
+        policy->nbDims = dim + 1;
+    }
+    return &policy->dims[dim];
+}
+
+static int32_t* mingraph_policyAlloc(size_t size, void* data)
+{
+    return (int32_t*)malloc(size * sizeof(int32_t));
+}
+
+/* @return the CPU time of the calling thread in ns, so that the
+ * threads of the worker pools do not count. Windows and strict
+ * ISO C builds fall back to the CPU time of the process.
+ */
+static double mingraph_now(void)
+{
+#if !defined(_WIN32) && defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+#else
+    return (double)clock() * (1e9 / CLOCKS_PER_SEC);
+#endif
+}
+
+/* Time dbm_relationWithMinDBM on all the encodings of an analyzed DBM,
+ * with the constraints on 16 bits or not as they will be written.
+ * The DBM is compared with itself so that all the constraints are read.
+ */
+static void mingraph_measure(mingraph_dimPolicy_t* dimPolicy, const raw_t* dbm, cindex_t dim,
+                             const uint32_t* bitMatrix, size_t cnt, bool constraints16)
+{
+    allocator_t c_alloc = {NULL, mingraph_policyAlloc};
+    double reads[mingraph_NB_ENCODINGS];
+    uint32_t e, r;
+
+    mingraph_getReads(dim, cnt, reads);
+    for (e = 0; e < mingraph_NB_ENCODINGS; ++e) {
+        int32_t* mingraph =
+            mingraph_encodeAs(dbm, dim, bitMatrix, cnt, constraints16, (mingraph_encoding_t)e, c_alloc, 0);
+        double start = mingraph_now();
+        for (r = 0; r < MINGRAPH_POLICY_REPEATS; ++r) {
+            relation_t rel = dbm_relationWithMinDBM(dbm, dim, mingraph, NULL);
+            assert(rel & base_SUBSET);
+            (void)rel;
+        }
+        dimPolicy->time[e] += mingraph_now() - start;
+        dimPolicy->reads[e] += reads[e] * MINGRAPH_POLICY_REPEATS;
+        dimPolicy->stats.readCost[e] = dimPolicy->time[e] / dimPolicy->reads[e];
+        free(mingraph);
+    }
+    dimPolicy->stats.nbMeasured++;
+}
+
+/* Choose an encoding according to the objective of the policy.
+ * The size and the read cost of every encoding are divided by
+ * the smallest ones and blended.
+ */
+static mingraph_encoding_t mingraph_choose(const mingraph_policy_t* policy, const mingraph_dimPolicy_t* dimPolicy,
+                                           cindex_t dim, size_t cnt, bool constraints16)
+{
+    size_t sizes[mingraph_NB_ENCODINGS];
+    double reads[mingraph_NB_ENCODINGS], costs[mingraph_NB_ENCODINGS];
+    double minSize, minCost, bestScore = 0.0;
+    double w = policy->objective == dbm_MINDBM_FOR_SPEED ? 1.0 : policy->speedWeight;
+    uint32_t bitCode, e;
+    mingraph_encoding_t best = mingraph_ENCODE_COPY;
+
+    mingraph_getEncodingSizes(dim, cnt, constraints16, sizes, &bitCode);
+    mingraph_getReads(dim, cnt, reads);
+
+    minSize = (double)sizes[0];
+    minCost = costs[0] = reads[0] * dimPolicy->stats.readCost[0];
+    for (e = 1; e < mingraph_NB_ENCODINGS; ++e) {
+        costs[e] = reads[e] * dimPolicy->stats.readCost[e];
+        if (minSize > (double)sizes[e]) {
+            minSize = (double)sizes[e];
+        }
+        if (minCost > costs[e]) {
+            minCost = costs[e];
+        }
+    }
+    if (minCost <= 0.0) {
+        /* timer too coarse: everything is free */
+        w = 0.0;
+        minCost = 1.0;
+    }
+    for (e = 0; e < mingraph_NB_ENCODINGS; ++e) {
+        double score = (1.0 - w) * (double)sizes[e] / minSize + w * costs[e] / minCost;
+        if (e == 0 || score < bestScore) {
+            bestScore = score;
+            best = (mingraph_encoding_t)e;
+        }
+    }
+    return best;
+}
+
+/* Count a written mingraph in the statistics.
+ */
+static void mingraph_record(mingraph_dimPolicy_t* dimPolicy, const int32_t* mingraph)
+{
+    uint32_t e;
+
+    switch (dbm_getRepresentationType(mingraph)) {
+    case dbm_MINDBM_COPY32:
+    case dbm_MINDBM_COPY16: e = mingraph_ENCODE_COPY; break;
+    case dbm_MINDBM_BITMATRIX32:
+    case dbm_MINDBM_BITMATRIX16: e = mingraph_ENCODE_BITMATRIX; break;
+    case dbm_MINDBM_TUPLES32:
+    case dbm_MINDBM_TUPLES16: e = mingraph_ENCODE_COUPLESIJ; break;
+    default: return; /* trivial */
+    }
+    dimPolicy->stats.nbWritten[e]++;
+    dimPolicy->stats.sizeWritten[e] += dbm_getSizeOfMinDBM(mingraph);
+}
+
+/*****************************
+ * Implementation of the API.
+ *****************************/
+
+mingraph_policy_t* dbm_newMinDBMPolicy(objectiveOfMinDBM_t objective, double speedWeight)
+{
+    mingraph_policy_t* policy = (mingraph_policy_t*)malloc(sizeof(mingraph_policy_t));
+
+    assert(policy);
+    assert(speedWeight >= 0.0 && speedWeight <= 1.0);
+
+    policy->objective = objective;
+    policy->speedWeight = objective == dbm_MINDBM_FOR_BLEND ? speedWeight : 0.0;
+    policy->dims = NULL;
+    policy->nbDims = 0;
+    return policy;
+}
+
+void dbm_deleteMinDBMPolicy(mingraph_policy_t* policy)
+{
+    if (policy) {
+        free(policy->dims);
+        free(policy);
+    }
+}
+
+void dbm_calibrateMinDBMPolicy(mingraph_policy_t* policy, const raw_t* dbms, size_t nbDBMs, cindex_t dim)
+{
+    mingraph_dimPolicy_t* dimPolicy;
+    uint32_t* bitMatrix;
+    size_t k;
+
+    assert(policy && dbms && dim);
+
+    if (dim <= 2) {
+        return; /* always copied */
+    }
+    dimPolicy = mingraph_getDimPolicy(policy, dim);
+    memset(dimPolicy->time, 0, sizeof(dimPolicy->time));
+    memset(dimPolicy->reads, 0, sizeof(dimPolicy->reads));
+    memset(dimPolicy->stats.readCost, 0, sizeof(dimPolicy->stats.readCost));
+    dimPolicy->stats.nbMeasured = 0;
+
+    bitMatrix = (uint32_t*)calloc(bits2intsize(dim * dim), sizeof(uint32_t));
+    for (k = 0; k < nbDBMs; ++k, dbms += dim * dim) {
+        size_t cnt = dbm_cleanBitMatrix(dbms, dim, bitMatrix, dbm_analyzeForMinDBM(dbms, dim, bitMatrix));
+        if (cnt) {
+            /* as written with tryConstraints16 */
+            mingraph_measure(dimPolicy, dbms, dim, bitMatrix, cnt, dbm_getMaxRange(dbms, dim) < dbm_LS_INF16);
+        }
+    }
+    free(bitMatrix);
+}
+
+/* Algorithm:
+ * - the size objective and dim <= 2 are the default writer
+ * - analyze, measure while sampling, choose and encode
+ */
+int32_t* dbm_writeToMinDBMWithPolicy(mingraph_policy_t* policy, const raw_t* dbm, cindex_t dim,
+                                     bool tryConstraints16, allocator_t c_alloc, size_t offset)
+{
+    int32_t* mingraph;
+
+    assert(policy && dbm && dim);
+
+    if (dim <= 2) {
+        return dbm_writeToMinDBMWithOffset(dbm, dim, true, tryConstraints16, c_alloc, offset);
+    }
+    if (policy->objective == dbm_MINDBM_FOR_SIZE) {
+        mingraph = dbm_writeToMinDBMWithOffset(dbm, dim, true, tryConstraints16, c_alloc, offset);
+    } else {
+        uint32_t* bitMatrix = (uint32_t*)calloc(bits2intsize(dim * dim), sizeof(uint32_t));
+        size_t cnt = dbm_cleanBitMatrix(dbm, dim, bitMatrix, dbm_analyzeForMinDBM(dbm, dim, bitMatrix));
+
+        if (!cnt) {
+            mingraph = dbm_writeAnalyzedDBM(dbm, dim, bitMatrix, cnt, tryConstraints16, c_alloc, offset);
+        } else {
+            mingraph_dimPolicy_t* dimPolicy = mingraph_getDimPolicy(policy, dim);
+            bool constraints16 = tryConstraints16 && (dbm_getMaxRange(dbm, dim) < dbm_LS_INF16);
+
+            if (dimPolicy->stats.nbMeasured < MINGRAPH_POLICY_SAMPLES) {
+                mingraph_measure(dimPolicy, dbm, dim, bitMatrix, cnt, constraints16);
+            }
+            mingraph = mingraph_encodeAs(dbm, dim, bitMatrix, cnt, constraints16,
+                                         mingraph_choose(policy, dimPolicy, dim, cnt, constraints16), c_alloc,
+                                         offset);
+        }
+        free(bitMatrix);
+    }
+    mingraph_record(mingraph_getDimPolicy(policy, dim), mingraph + offset);
+    return mingraph;
+}
+
+const statsOfMinDBMPolicy_t* dbm_getStatsOfMinDBMPolicy(const mingraph_policy_t* policy, cindex_t dim)
+{
+    const statsOfMinDBMPolicy_t* stats;
+
+    assert(policy);
+    if (dim >= policy->nbDims) {
+        return NULL;
+    }
+    stats = &policy->dims[dim].stats;
+    return (stats->nbMeasured | stats->nbWritten[0] | stats->nbWritten[1] | stats->nbWritten[2]) ? stats : NULL;
+}
@@ -20,6 +20,13 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+/* Native block decoding kernels on x86-64, selected at run-time. */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(MINGRAPH_NO_NATIVE_KERNELS)
+#define MINGRAPH_NATIVE_KERNELS
+#include <immintrin.h>
+#endif
 
 /*#define EXPERIMENTAL*/
 
@@ -42,6 +49,11 @@ static cindex_t mingraph_readFromMinBitMatrix16(raw_t* dbm, const int32_t* mingr
 static cindex_t mingraph_readFromMinCouplesij32(raw_t* dbm, const int32_t* mingraph);
 static cindex_t mingraph_readFromMinCouplesij16(raw_t* dbm, const int32_t* mingraph);
 static cindex_t mingraph_readError(raw_t* dbm, const int32_t* mingraph);
+static cindex_t mingraph_blockReadFromCopy16(raw_t* dbm, const int32_t* mingraph);
+static cindex_t mingraph_blockReadFromBitMatrix32(raw_t* dbm, const int32_t* mingraph);
+static cindex_t mingraph_blockReadFromBitMatrix16(raw_t* dbm, const int32_t* mingraph);
+static cindex_t mingraph_blockReadFromCouplesij32(raw_t* dbm, const int32_t* mingraph);
+static cindex_t mingraph_blockReadFromCouplesij16(raw_t* dbm, const int32_t* mingraph);
 
 /* For reading the bit matrix from mingraph_t */
 static size_t mingraph_bitMatrixFromCopy32(uint32_t* bitMatrix, const int32_t* mingraph, bool isUnpacked,
@@ -108,23 +120,36 @@ bool dbm_mingraphHasZero(const int32_t* minDBM)
  */
 typedef cindex_t (*readDBM_f)(raw_t*, const int32_t*);
 
+/* Decoding functions, see mingraph_getTypeIndex comments.
+ */
+static const readDBM_f referenceReadFromMinDBM[8] = {mingraph_readFromCopy32,
+                                                     mingraph_readFromCopy16,
+                                                     mingraph_readError,
+                                                     mingraph_readError,
+                                                     mingraph_readFromMinBitMatrix32,
+                                                     mingraph_readFromMinBitMatrix16,
+                                                     mingraph_readFromMinCouplesij32,
+                                                     mingraph_readFromMinCouplesij16};
+static const readDBM_f blockReadFromMinDBM[8] = {mingraph_readFromCopy32,
+                                                 mingraph_blockReadFromCopy16,
+                                                 mingraph_readError,
+                                                 mingraph_readError,
+                                                 mingraph_blockReadFromBitMatrix32,
+                                                 mingraph_blockReadFromBitMatrix16,
+                                                 mingraph_blockReadFromCouplesij32,
+                                                 mingraph_blockReadFromCouplesij16};
+
+/* Current decoder, see dbm_setMinDBMDecoder.
+ */
+static const readDBM_f* readFromMinDBM = blockReadFromMinDBM;
+static decoderOfMinDBM_t mingraph_decoder = dbm_DECODE_PORTABLE;
+
 /* Algorithm:
  * 1) check the format
  * 2) call the proper decoding function
  */
 cindex_t dbm_readFromMinDBM(raw_t* dbm, const int32_t* minDBM)
 {
-    /* see mingraph_getTypeIndex comments
-     */
-    static const readDBM_f readFromMinDBM[8] = {mingraph_readFromCopy32,
-                                                mingraph_readFromCopy16,
-                                                mingraph_readError,
-                                                mingraph_readError,
-                                                mingraph_readFromMinBitMatrix32,
-                                                mingraph_readFromMinBitMatrix16,
-                                                mingraph_readFromMinCouplesij32,
-                                                mingraph_readFromMinCouplesij16};
-
     assert(dbm && minDBM);
     assert(mingraph_readDimFromPtr(minDBM) > 0);
 
@@ -142,6 +167,30 @@ cindex_t dbm_readFromMinDBM(raw_t* dbm, const int32_t* minDBM)
     return readFromMinDBM[mingraph_getTypeIndexFromPtr(minDBM)](dbm, minDBM);
 }
 
+/* Batch decoding: the dimension is checked once and the
+ * decoding functions are called directly.
+ */
+void dbm_readFromMinDBMs(raw_t* dbms, cindex_t dim, const int32_t* arena, const size_t* offsets, size_t nbDBMs)
+{
+    size_t k, dim2 = dim * dim;
+
+    assert(dbms && dim && arena && offsets);
+
+    if (dim <= 1) {
+        for (k = 0; k < nbDBMs; ++k) {
+            assert(dbm_getDimOfMinDBM(arena + offsets[k]) == dim);
+            dbms[k] = dbm_LE_ZERO;
+        }
+        return;
+    }
+
+    for (k = 0; k < nbDBMs; ++k, dbms += dim2) {
+        const int32_t* minDBM = arena + offsets[k];
+        assert(mingraph_readDimFromPtr(minDBM) == dim);
+        readFromMinDBM[mingraph_getTypeIndexFromPtr(minDBM)](dbms, minDBM);
+    }
+}
+
 /* Type of the bit matrix decoding functions.
  */
 typedef size_t (*bitMatrixDBM_f)(uint32_t*, const int32_t*, bool, raw_t*);
@@ -659,6 +708,313 @@ static cindex_t mingraph_readError(raw_t* dbm, const int32_t* mingraph)
     return 0; /* compiler happy */
 }
 
+/*****************************************************
+ * Block decoding: the indices of the constraints are
+ * unpacked and the constraints widened to 32 bits in
+ * tight loops, then the constraints are scattered
+ * into the DBM. The native kernels use BMI2 (pdep,
+ * tzcnt) and AVX2 (16 to 32 bit widening) when the
+ * CPU has them. The reference decoders above read
+ * constraint by constraint and are kept to check the
+ * block decoders, see dbm_setMinDBMDecoder.
+ *****************************************************/
+
+/* Kernels of the block decoders, couples are written as i | (j << 16).
+ */
+typedef struct
+{
+    /* finite constraints from 16 to 32 bits */
+    void (*widen16)(raw_t* out, const int16_t* in, size_t n);
+    /* constraints or infinity from 16 to 32 bits */
+    void (*widenRaw16)(raw_t* out, const int16_t* in, size_t n);
+    /* n couples of indices on bitSize bits */
+    void (*unpackCouples)(uint32_t* couples, const uint32_t* packed, uint32_t bitSize, size_t n);
+    /* the n constraints marked in a bit matrix */
+    void (*bitMatrix2couples)(uint32_t* couples, const uint32_t* bitMatrix, size_t n, cindex_t dim);
+} mingraph_kernels_t;
+
+static void mingraph_widen16(raw_t* out, const int16_t* in, size_t n)
+{
+    size_t k;
+    for (k = 0; k < n; ++k) {
+        out[k] = in[k]; /* = mingraph_finite16to32 */
+    }
+}
+
+static void mingraph_widenRaw16(raw_t* out, const int16_t* in, size_t n)
+{
+    size_t k;
+    for (k = 0; k < n; ++k) {
+        out[k] = in[k] == dbm_LS_INF16 ? dbm_LS_INFINITY : in[k]; /* = mingraph_raw16to32 */
+    }
+}
+
+/* Couples on 4 or 8 bits, 32/(2*bitSize) per int. */
+static inline void mingraph_unpackSmallCouples(uint32_t* couples, const uint32_t* packed, uint32_t bitSize, size_t n)
+{
+    uint32_t mask = (1u << bitSize) - 1;
+    uint32_t perInt = 16 / bitSize;
+    size_t k = 0;
+
+    for (; k + perInt <= n; ++packed) {
+        uint32_t val_ij = *packed, c;
+        for (c = 0; c < perInt; ++c, ++k, val_ij >>= 2 * bitSize) {
+            couples[k] = (val_ij & mask) | ((val_ij >> bitSize) & mask) << 16;
+        }
+    }
+    if (k < n) { /* last int, partially used */
+        uint32_t val_ij = *packed;
+        for (; k < n; ++k, val_ij >>= 2 * bitSize) {
+            couples[k] = (val_ij & mask) | ((val_ij >> bitSize) & mask) << 16;
+        }
+    }
+}
+
+static void mingraph_unpackCouples(uint32_t* couples, const uint32_t* packed, uint32_t bitSize, size_t n)
+{
+    switch (bitSize) {
+    case 4: mingraph_unpackSmallCouples(couples, packed, 4, n); break;
+    case 8: mingraph_unpackSmallCouples(couples, packed, 8, n); break;
+    default: /* one couple i | (j << 16) per int */
+        assert(bitSize == 16);
+        memcpy(couples, packed, n * sizeof(uint32_t));
+    }
+}
+
+/* Jump to the set bits, tracking the row incrementally. */
+static inline void mingraph_bitMatrix2couplesInline(uint32_t* couples, const uint32_t* bitMatrix, size_t n,
+                                                    cindex_t dim)
+{
+    size_t k, rowEnd = dim; /* index of the end of row i */
+    cindex_t i = 0;
+
+    for (k = 0; n != 0; k += 32) {
+        uint32_t b;
+        for (b = *bitMatrix++; b != 0; b &= b - 1) {
+            size_t kb = k + mingraph_lowestBit(b);
+            for (; kb >= rowEnd; rowEnd += dim) {
+                ++i;
+            }
+            *couples++ = i | ((uint32_t)(kb + dim - rowEnd) << 16);
+            --n;
+        }
+    }
+}
+
+static void mingraph_bitMatrix2couples(uint32_t* couples, const uint32_t* bitMatrix, size_t n, cindex_t dim)
+{
+    mingraph_bitMatrix2couplesInline(couples, bitMatrix, n, dim);
+}
+
+static const mingraph_kernels_t mingraph_portableKernels = {mingraph_widen16, mingraph_widenRaw16,
+                                                            mingraph_unpackCouples, mingraph_bitMatrix2couples};
+
+#ifdef MINGRAPH_NATIVE_KERNELS
+
+__attribute__((target("avx2"))) static void mingraph_widen16AVX2(raw_t* out, const int16_t* in, size_t n)
+{
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        __m128i raw16 = _mm_loadu_si128((const __m128i*)(in + k));
+        _mm256_storeu_si256((__m256i*)(out + k), _mm256_cvtepi16_epi32(raw16));
+    }
+    mingraph_widen16(out + k, in + k, n - k);
+}
+
+__attribute__((target("avx2"))) static void mingraph_widenRaw16AVX2(raw_t* out, const int16_t* in, size_t n)
+{
+    const __m256i inf16 = _mm256_set1_epi32(dbm_LS_INF16);
+    const __m256i inf32 = _mm256_set1_epi32(dbm_LS_INFINITY);
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        __m256i raw32 = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(in + k)));
+        raw32 = _mm256_blendv_epi8(raw32, inf32, _mm256_cmpeq_epi32(raw32, inf16));
+        _mm256_storeu_si256((__m256i*)(out + k), raw32);
+    }
+    mingraph_widenRaw16(out + k, in + k, n - k);
+}
+
+/* pdep deposits i in bits 0.. and j in bits 16.. of a couple. */
+__attribute__((target("bmi2"))) static void mingraph_unpackCouplesBMI2(uint32_t* couples, const uint32_t* packed,
+                                                                        uint32_t bitSize, size_t n)
+{
+    uint32_t mask = bitSize == 4 ? 0x000f000f : 0x00ff00ff;
+    uint32_t perInt = 16 / bitSize;
+    size_t k = 0;
+
+    if (bitSize == 16) {
+        mingraph_unpackCouples(couples, packed, bitSize, n);
+        return;
+    }
+    for (; k + perInt <= n; ++packed) {
+        uint32_t val_ij = *packed, c;
+        for (c = 0; c < perInt; ++c, ++k, val_ij >>= 2 * bitSize) {
+            couples[k] = _pdep_u32(val_ij, mask);
+        }
+    }
+    if (k < n) { /* last int, partially used */
+        uint32_t val_ij = *packed;
+        for (; k < n; ++k, val_ij >>= 2 * bitSize) {
+            couples[k] = _pdep_u32(val_ij, mask);
+        }
+    }
+}
+
+/* Same as mingraph_bitMatrix2couples with tzcnt and blsr. */
+__attribute__((target("bmi,bmi2"))) static void mingraph_bitMatrix2couplesBMI2(uint32_t* couples,
+                                                                                const uint32_t* bitMatrix, size_t n,
+                                                                                cindex_t dim)
+{
+    mingraph_bitMatrix2couplesInline(couples, bitMatrix, n, dim);
+}
+
+static const mingraph_kernels_t mingraph_nativeKernels = {mingraph_widen16AVX2, mingraph_widenRaw16AVX2,
+                                                          mingraph_unpackCouplesBMI2, mingraph_bitMatrix2couplesBMI2};
+
+static bool mingraph_hasNativeKernels(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2");
+}
+
+#endif /* MINGRAPH_NATIVE_KERNELS */
+
+/* Kernels of the block decoders, portable until the native ones are selected. */
+static const mingraph_kernels_t* mingraph_kernels = &mingraph_portableKernels;
+
+/* Scatter n constraints of couples (i,j) into dbm and close it.
+ * @param touched: bits2intsize(dim) ints for the touched clocks.
+ */
+static void mingraph_scatter(raw_t* dbm, cindex_t dim, const uint32_t* couples, const raw_t* constraints, size_t n,
+                             uint32_t* touched)
+{
+    size_t k;
+
+    base_resetBits(touched, bits2intsize(dim));
+    dbm_init(dbm, dim);
+    for (k = 0; k < n; ++k) {
+        cindex_t i = couples[k] & 0xffff, j = couples[k] >> 16;
+        assert(i < dim && j < dim && i != j);
+        dbm[i * dim + j] = constraints[k];
+        if (i) {
+            base_setOneBit(touched, i);
+            base_setOneBit(touched, j);
+        }
+    }
+    if (n) {
+        dbm_closex(dbm, dim, touched);
+    }
+}
+
+/* Unpack the couples (and the constraints if constraints16)
+ * of a minimal graph and scatter them. The buffers of the
+ * couples, the widened constraints and the touched clocks
+ * are on the stack for small mingraphs.
+ */
+enum { mingraph_LOCAL_CONSTRAINTS = 128, mingraph_LOCAL_DIM = 256 };
+
+static cindex_t mingraph_blockRead(raw_t* dbm, const int32_t* mingraph, bool constraints16, bool bitMatrix)
+{
+    uint32_t info = mingraph_getInfo(mingraph);
+    cindex_t dim = mingraph_readDim(info);
+    size_t n = mingraph_getNbConstraints(mingraph);
+    const raw_t* data = mingraph_getCodedData(mingraph);
+    const uint32_t* indices =
+        constraints16 ? mingraph_jumpConstInt16((const int16_t*)data, n) : (const uint32_t*)&data[n];
+    uint32_t local[2 * mingraph_LOCAL_CONSTRAINTS + mingraph_LOCAL_DIM / 32];
+    uint32_t* couples = n <= mingraph_LOCAL_CONSTRAINTS && dim <= mingraph_LOCAL_DIM
+                            ? local
+                            : (uint32_t*)malloc((2 * n + bits2intsize(dim)) * sizeof(uint32_t));
+    const raw_t* constraints = data;
+
+    assert(dbm && (dim > 2 || n == 0));
+
+    if (bitMatrix) {
+        assert(n && base_countBitsN(indices, bits2intsize(dim * dim)) == n);
+        mingraph_kernels->bitMatrix2couples(couples, indices, n, dim);
+    } else if (n) {
+        /* see mingraph_readFromMinCouplesij32 for the size of the indices */
+        mingraph_kernels->unpackCouples(couples, indices, 1u << (mingraph_typeOfIJ(info) + 2), n);
+    }
+    if (constraints16) {
+        mingraph_kernels->widen16((raw_t*)couples + n, (const int16_t*)data, n);
+        constraints = (raw_t*)couples + n;
+    }
+    mingraph_scatter(dbm, dim, couples, constraints, n, couples + 2 * n);
+
+    if (couples != local) {
+        free(couples);
+    }
+    return dim;
+}
+
+static cindex_t mingraph_blockReadFromCopy16(raw_t* dbm, const int32_t* mingraph)
+{
+    cindex_t dim = mingraph_readDimFromPtr(mingraph);
+    const int16_t* saved = (int16_t*)&mingraph[1]; /* constraints after info */
+    cindex_t i;
+
+    assert(dim > 1);
+
+    /* dim constraints between two diagonal elements */
+    for (i = 0; i < dim - 1; ++i, dbm += dim + 1, saved += dim) {
+        *dbm = dbm_LE_ZERO;
+        mingraph_kernels->widenRaw16(dbm + 1, saved, dim);
+    }
+    *dbm = dbm_LE_ZERO;
+    return dim;
+}
+
+static cindex_t mingraph_blockReadFromBitMatrix32(raw_t* dbm, const int32_t* mingraph)
+{
+    return mingraph_blockRead(dbm, mingraph, false, true);
+}
+
+static cindex_t mingraph_blockReadFromBitMatrix16(raw_t* dbm, const int32_t* mingraph)
+{
+    return mingraph_blockRead(dbm, mingraph, true, true);
+}
+
+static cindex_t mingraph_blockReadFromCouplesij32(raw_t* dbm, const int32_t* mingraph)
+{
+    return mingraph_blockRead(dbm, mingraph, false, false);
+}
+
+static cindex_t mingraph_blockReadFromCouplesij16(raw_t* dbm, const int32_t* mingraph)
+{
+    return mingraph_blockRead(dbm, mingraph, true, false);
+}
+
+#ifdef MINGRAPH_NATIVE_KERNELS
+/* Select the native kernels when the library is loaded. */
+__attribute__((constructor)) static void mingraph_initDecoder(void) { dbm_setMinDBMDecoder(dbm_DECODE_NATIVE); }
+#endif
+
+bool dbm_setMinDBMDecoder(decoderOfMinDBM_t decoder)
+{
+    switch (decoder) {
+    case dbm_DECODE_REFERENCE: readFromMinDBM = referenceReadFromMinDBM; break;
+    case dbm_DECODE_PORTABLE:
+        readFromMinDBM = blockReadFromMinDBM;
+        mingraph_kernels = &mingraph_portableKernels;
+        break;
+    case dbm_DECODE_NATIVE:
+#ifdef MINGRAPH_NATIVE_KERNELS
+        if (mingraph_hasNativeKernels()) {
+            readFromMinDBM = blockReadFromMinDBM;
+            mingraph_kernels = &mingraph_nativeKernels;
+            break;
+        }
+#endif
+        return false;
+    default: return false;
+    }
+    mingraph_decoder = decoder;
+    return true;
+}
+
+decoderOfMinDBM_t dbm_getMinDBMDecoder(void) { return mingraph_decoder; }
+
 /**************************************************
  * Format dependent bit matrix decoding functions *
  **************************************************/
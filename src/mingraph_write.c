@@ -33,8 +33,13 @@
  *******************************/
 
 /* Compute sizes and choose encoding, see below */
+static mingraph_encoding_t mingraph_chooseEncoding(cindex_t dim, size_t cnt, bool constraints16, size_t* size,
+                                                   uint32_t* bitCode);
 static int32_t* mingraph_encode(const raw_t* dbm, cindex_t dim, const uint32_t* bitMatrix, size_t cnt,
                                 bool constraints16, allocator_t c_alloc, size_t offset);
+static int32_t* mingraph_encodeSized(const raw_t* dbm, cindex_t dim, const uint32_t* bitMatrix, size_t cnt,
+                                     bool constraints16, mingraph_encoding_t encoding, size_t size, uint32_t bitCode,
+                                     allocator_t c_alloc, size_t offset);
 
 /* Internal analysis function: compute minimal graph, see below */
 static size_t mingraph_analyzeForMinDBM(const raw_t* dbm, cindex_t dim, uint32_t* bitMatrix);
@@ -210,40 +215,120 @@ int32_t* dbm_writeAnalyzedDBM(const raw_t* dbm, cindex_t dim, uint32_t* bitMatri
                            tryConstraints16 && (dbm_getMaxRange(dbm, dim) < dbm_LS_INF16), c_alloc, offset);
 }
 
+/* Arena "allocation": return the place reserved
+ * in the arena by dbm_getSizeOfMinDBMsFor.
+ */
+typedef struct
+{
+    int32_t* where; /* reserved place          */
+    size_t size;    /* its size, for debugging */
+} mingraph_arena_t;
+
+static int32_t* mingraph_arenaAlloc(size_t size, void* data)
+{
+    mingraph_arena_t* arena = (mingraph_arena_t*)data;
+    ASSERT(size == arena->size, fprintf(stderr, "size %zu != reserved %zu\n", size, arena->size));
+    return arena->where;
+}
+
+/* Same sizes as mingraph_writeMinDBMDim2.
+ */
+static size_t mingraph_getSizeOfDim2(const raw_t* dbm, cindex_t dim)
+{
+    raw_t maxBits = 0;
+
+    if (dim <= 1 || (dbm[1] == dbm_LE_ZERO && dbm[2] == dbm_LS_INFINITY)) {
+        return 1;
+    }
+    ADD_BITS(maxBits, dbm[1]);
+    ADD_BITS(maxBits, dbm[2]);
+    return maxBits >= dbm_LS_INF16 ? 3 : 2;
+}
+
+/* Phase 1 of the batch encoding: analyze all the DBMs
+ * (the minimal graphs are kept for phase 2) and compute
+ * the sizes with the same choices as dbm_writeToMinDBMWithOffset.
+ */
+size_t dbm_getSizeOfMinDBMsFor(const raw_t* dbms, size_t nbDBMs, cindex_t dim, bool minimizeGraph,
+                               bool tryConstraints16, uint32_t* bitMatrices, size_t* offsets)
+{
+    size_t k, dim2 = dim * dim, bitSize = bits2intsize(dim2), total = 0;
+
+    assert(dim <= 0xffff); /* fits on 16 bits */
+    assert(dbms && dim && offsets);
+    assert(!minimizeGraph || dim <= 2 || bitMatrices);
+
+    for (k = 0; k < nbDBMs; ++k, dbms += dim2) {
+        size_t size;
+
+        assert(!dbm_isEmpty(dbms, dim));
+        offsets[k] = total;
+
+        if (dim <= 2) {
+            size = mingraph_getSizeOfDim2(dbms, dim);
+        } else {
+            bool constraints16 = tryConstraints16 && (dbm_getMaxRange(dbms, dim) < dbm_LS_INF16);
+            if (minimizeGraph) {
+                uint32_t* bitMatrix = bitMatrices + k * bitSize;
+                size_t cnt = dbm_cleanBitMatrix(dbms, dim, bitMatrix, mingraph_analyzeForMinDBM(dbms, dim, bitMatrix));
+                uint32_t bitCode;
+                size = 1; /* no constraint */
+                if (cnt) {
+                    mingraph_chooseEncoding(dim, cnt, constraints16, &size, &bitCode);
+                }
+            } else {
+                size = 1 + ((dim * (dim - 1) + constraints16) >> constraints16);
+            }
+        }
+        total += size;
+    }
+    offsets[nbDBMs] = total;
+
+    return total;
+}
+
+/* Phase 2 of the batch encoding: encode in place with an
+ * allocator returning the reserved places in the arena.
+ */
+void dbm_writeToMinDBMs(const raw_t* dbms, size_t nbDBMs, cindex_t dim, bool minimizeGraph, bool tryConstraints16,
+                        uint32_t* bitMatrices, const size_t* offsets, int32_t* arena)
+{
+    size_t k, dim2 = dim * dim, bitSize = bits2intsize(dim2);
+    mingraph_arena_t reserved;
+    allocator_t c_alloc = {.allocData = &reserved, .allocFunction = mingraph_arenaAlloc};
+
+    assert(dbms && dim && offsets && arena);
+    assert(!minimizeGraph || dim <= 2 || bitMatrices);
+
+    for (k = 0; k < nbDBMs; ++k, dbms += dim2) {
+        reserved.where = arena + offsets[k];
+        reserved.size = offsets[k + 1] - offsets[k];
+
+        if (minimizeGraph && dim > 2) {
+            uint32_t* bitMatrix = bitMatrices + k * bitSize;
+            dbm_writeAnalyzedDBM(dbms, dim, bitMatrix, base_countBitsN(bitMatrix, bitSize), tryConstraints16,
+                                 c_alloc, 0);
+        } else {
+            dbm_writeToMinDBMWithOffset(dbms, dim, false, tryConstraints16, c_alloc, 0);
+        }
+    }
+}
+
 /********************************************
  * Implementation of the encoding functions *
  ********************************************/
 
-/** Estimate cheapest encoding and call the corresponding
- * encoding function.
- * @param dbm: dbm to save.
- * @param dim: dimension.
- * @param bitMatrix: bit matrix for the constraints to take.
- * @param cnt: number of constraints to save.
- * @param maxConstraint: maximal (!=infinity) constraint value.
- * @param allocFunction: allocation function.
- * @param allocData: custom data for the allocation function.
- * @param offset: offset to use for the allocation.
- * @return encoded minimal graph.
- * @pre dim > 2, otherwise always copy.
+/* Sizes of the encodings of a minimal graph, see mingraph_coding.h.
+ * The indices i,j of the couples are on 4, 8, or 16 bits.
  */
-static int32_t* mingraph_encode(const raw_t* dbm, cindex_t dim, const uint32_t* bitMatrix, size_t cnt,
-                                bool constraints16, allocator_t c_alloc, size_t offset)
+void mingraph_getEncodingSizes(cindex_t dim, size_t cnt, bool constraints16, size_t* sizes, uint32_t* bitCode)
 {
     size_t sizeForConstraints; /* to save the constraints (16/32 bits) */
     size_t sizeForInfo;        /* info may be on 1 or 2 ints           */
     size_t sizeForIndices;     /* to save the couples i,j              */
 
-    size_t sizeIfCopy;      /* total size if copy                       */
-    size_t sizeIfBitMatrix; /* total size if min. red. with bit matrix  */
-    size_t sizeIfCouplesij; /* total size if min. red. with couples i,j */
-
-    uint32_t bitCode = 0; /* used to code bits of couples i,j */
-    int32_t* mingraph;    /* result                           */
-
     assert(dim > 2);
     assert(cnt > 0);
-    assert(base_countBitsN(bitMatrix, bits2intsize(dim * dim)) == cnt);
 
     /* Size to allocate for constraints
      */
@@ -255,38 +340,59 @@ static int32_t* mingraph_encode(const raw_t* dbm, cindex_t dim, const uint32_t*
 
     /* Size to allocate if copy is used
      */
-    sizeIfCopy = 1 + /* overhead for info */
-                 /* conditional /2 rounded up */
-                 ((dim * (dim - 1) + constraints16) >> constraints16);
+    sizes[mingraph_ENCODE_COPY] = 1 + /* overhead for info */
+                                  /* conditional /2 rounded up */
+                                  ((dim * (dim - 1) + constraints16) >> constraints16);
 
     /* Size to allocate if bit matrix is used
      */
-    sizeIfBitMatrix = sizeForInfo +            /* information */
-                      sizeForConstraints +     /* constraints */
-                      bits2intsize(dim * dim); /* bit matrix  */
+    sizes[mingraph_ENCODE_BITMATRIX] = sizeForInfo +            /* information */
+                                       sizeForConstraints +     /* constraints */
+                                       bits2intsize(dim * dim); /* bit matrix  */
 
     /* Representation of indices ij: 4, 8, 16 bits
      * 2* because we are saving couples (i,j).
      */
     if (dim <= 16) {
         /* 2 * cnt * 4bits = 8*cnt */
-        bitCode = 0;
+        *bitCode = 0;
         sizeForIndices = bits2intsize(cnt << 3);
     } else if (dim <= 256) {
         /* 2 * cnt * 8bits = 16*cnt */
-        bitCode = 1;
+        *bitCode = 1;
         sizeForIndices = bits2intsize(cnt << 4);
     } else {
         /* 2 * cnt * 16bits = 32*cnt */
-        bitCode = 2;
+        *bitCode = 2;
         sizeForIndices = bits2intsize(cnt << 5);
     }
 
     /* Size to allocate if couples_ij are used
      */
-    sizeIfCouplesij = sizeForInfo +        /* information */
-                      sizeForConstraints + /* constraints */
-                      sizeForIndices;      /* indices i,j */
+    sizes[mingraph_ENCODE_COUPLESIJ] = sizeForInfo +        /* information */
+                                       sizeForConstraints + /* constraints */
+                                       sizeForIndices;      /* indices i,j */
+}
+
+/** Estimate the cheapest encoding of a minimal graph.
+ * @param dim: dimension.
+ * @param cnt: number of constraints to save.
+ * @param constraints16: if the constraints are saved on 16 bits.
+ * @param size: where to write the size of the cheapest encoding.
+ * @param bitCode: where to write the code of the bits of couples i,j.
+ * @return the cheapest encoding.
+ * @pre dim > 2, otherwise always copy.
+ */
+static mingraph_encoding_t mingraph_chooseEncoding(cindex_t dim, size_t cnt, bool constraints16, size_t* size,
+                                                   uint32_t* bitCode)
+{
+    size_t sizes[mingraph_NB_ENCODINGS];
+    size_t sizeIfCopy, sizeIfBitMatrix, sizeIfCouplesij;
+
+    mingraph_getEncodingSizes(dim, cnt, constraints16, sizes, bitCode);
+    sizeIfCopy = sizes[mingraph_ENCODE_COPY];
+    sizeIfBitMatrix = sizes[mingraph_ENCODE_BITMATRIX];
+    sizeIfCouplesij = sizes[mingraph_ENCODE_COUPLESIJ];
 
     /* Choose cheapest
      */
@@ -294,10 +400,8 @@ static int32_t* mingraph_encode(const raw_t* dbm, cindex_t dim, const uint32_t*
         if (sizeIfCopy <= sizeIfCouplesij) {
             /* copy <= bit matrix and copy <= couplesij
              */
-            mingraph = c_alloc.allocFunction(offset + sizeIfCopy, c_alloc.allocData);
-            (constraints16 ? mingraph_writeCopy16 : mingraph_writeCopy32)(mingraph + offset, dbm, dim);
-
-            return mingraph;
+            *size = sizeIfCopy;
+            return mingraph_ENCODE_COPY;
         }
         /* else we have
          * sizeIfCopy > sizeIfCouplesij &&
@@ -311,10 +415,8 @@ static int32_t* mingraph_encode(const raw_t* dbm, cindex_t dim, const uint32_t*
          */
         if (sizeIfCouplesij >= sizeIfBitMatrix) {
             /* bit matrix < copy and bit matrix <= couplesij */
-            mingraph = c_alloc.allocFunction(offset + sizeIfBitMatrix, c_alloc.allocData);
-            (constraints16 ? mingraph_writeMinBitMatrix16 : mingraph_writeMinBitMatrix32)(mingraph + offset, dbm, dim,
-                                                                                          bitMatrix, cnt);
-            return mingraph;
+            *size = sizeIfBitMatrix;
+            return mingraph_ENCODE_BITMATRIX;
         }
         /* else we have
          * sizeIfCouplesij < sizeIfBitMatrix &&
@@ -324,9 +426,75 @@ static int32_t* mingraph_encode(const raw_t* dbm, cindex_t dim, const uint32_t*
     }
 
     /* couplesij cheapest */
-    mingraph = c_alloc.allocFunction(offset + sizeIfCouplesij, c_alloc.allocData);
-    (constraints16 ? mingraph_writeMinCouplesij16 : mingraph_writeMinCouplesij32)(mingraph + offset, dbm, dim,
-                                                                                  bitMatrix, cnt, bitCode);
+    *size = sizeIfCouplesij;
+    return mingraph_ENCODE_COUPLESIJ;
+}
+
+/** Estimate cheapest encoding and call the corresponding
+ * encoding function.
+ * @param dbm: dbm to save.
+ * @param dim: dimension.
+ * @param bitMatrix: bit matrix for the constraints to take.
+ * @param cnt: number of constraints to save.
+ * @param maxConstraint: maximal (!=infinity) constraint value.
+ * @param allocFunction: allocation function.
+ * @param allocData: custom data for the allocation function.
+ * @param offset: offset to use for the allocation.
+ * @return encoded minimal graph.
+ * @pre dim > 2, otherwise always copy.
+ */
+static int32_t* mingraph_encode(const raw_t* dbm, cindex_t dim, const uint32_t* bitMatrix, size_t cnt,
+                                bool constraints16, allocator_t c_alloc, size_t offset)
+{
+    size_t size;
+    uint32_t bitCode = 0; /* used to code bits of couples i,j */
+    mingraph_encoding_t encoding = mingraph_chooseEncoding(dim, cnt, constraints16, &size, &bitCode);
+
+    return mingraph_encodeSized(dbm, dim, bitMatrix, cnt, constraints16, encoding, size, bitCode, c_alloc, offset);
+}
+
+/* Encode with a given encoding, see mingraph_coding.h.
+ */
+int32_t* mingraph_encodeAs(const raw_t* dbm, cindex_t dim, const uint32_t* bitMatrix, size_t cnt,
+                           bool constraints16, mingraph_encoding_t encoding, allocator_t c_alloc, size_t offset)
+{
+    size_t sizes[mingraph_NB_ENCODINGS];
+    uint32_t bitCode = 0; /* used to code bits of couples i,j */
+
+    mingraph_getEncodingSizes(dim, cnt, constraints16, sizes, &bitCode);
+    return mingraph_encodeSized(dbm, dim, bitMatrix, cnt, constraints16, encoding, sizes[encoding], bitCode, c_alloc,
+                                offset);
+}
+
+/** Encode with a given encoding whose size was computed by
+ * mingraph_getEncodingSizes, so that it is not computed again.
+ * @param size,bitCode: as given by mingraph_getEncodingSizes
+ * for the encoding.
+ * @see mingraph_encodeAs for the other parameters.
+ */
+static int32_t* mingraph_encodeSized(const raw_t* dbm, cindex_t dim, const uint32_t* bitMatrix, size_t cnt,
+                                     bool constraints16, mingraph_encoding_t encoding, size_t size, uint32_t bitCode,
+                                     allocator_t c_alloc, size_t offset)
+{
+    int32_t* mingraph = c_alloc.allocFunction(offset + size, c_alloc.allocData);
+
+    assert(base_countBitsN(bitMatrix, bits2intsize(dim * dim)) == cnt);
+
+    switch (encoding) {
+    case mingraph_ENCODE_COPY:
+        (constraints16 ? mingraph_writeCopy16 : mingraph_writeCopy32)(mingraph + offset, dbm, dim);
+        break;
+    case mingraph_ENCODE_BITMATRIX:
+        (constraints16 ? mingraph_writeMinBitMatrix16 : mingraph_writeMinBitMatrix32)(mingraph + offset, dbm, dim,
+                                                                                      bitMatrix, cnt);
+        break;
+    case mingraph_ENCODE_COUPLESIJ:
+        (constraints16 ? mingraph_writeMinCouplesij16 : mingraph_writeMinCouplesij32)(mingraph + offset, dbm, dim,
+                                                                                      bitMatrix, cnt, bitCode);
+        break;
+    default: assert(0);
+    }
+
     return mingraph;
 }
 
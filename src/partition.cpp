@@ -18,26 +18,23 @@
 #endif
 
 #ifndef REDUCE
-// static inline dbm::fed_t& REDUCE(dbm::fed_t& fed) { return fed.convexReduce(); }
-// static inline dbm::fed_t& REDUCE(dbm::fed_t& fed) { return fed.partitionReduce(); }
-// static inline dbm::fed_t& REDUCE(dbm::fed_t& fed) { return fed.convexReduce().expensiveReduce(); }
-// static inline dbm::fed_t& REDUCE(dbm::fed_t& fed) { return fed.expensiveConvexReduce(); }
-static inline dbm::fed_t& REDUCE(dbm::fed_t& fed) { return fed.mergeReduce(); }
-// static inline dbm::fed_t& REDUCE(dbm::fed_t& fed) { return fed.reduce(); }
-// static inline dbm::fed_t& REDUCE(dbm::fed_t& fed) { return fed.expensiveReduce(); }
-// static inline dbm::fed_t& REDUCE(dbm::fed_t& fed) { return fed.reduce().mergeReduce(); }
-// static inline dbm::fed_t& REDUCE(dbm::fed_t& fed) { return fed.noReduce(); }
+static inline dbm::fed_t& REDUCE(dbm::fed_t& fed) { return dbm::partition_t::getReducer().reduce(fed); }
 #endif
 #ifndef BIGREDUCE
 static inline void BIGREDUCE(dbm::fed_t& fed) { fed.expensiveConvexReduce(); }
 #endif
-
-// static inline void REDUCE_SKIP(dbm::fed_t& fed, size_t s) { REDUCE(fed); }
-static inline void REDUCE_SKIP(dbm::fed_t& fed, size_t s) { fed.mergeReduce(s); }
-// static inline void REDUCE_SKIP(dbm::fed_t& fed, size_t s) { fed.mergeReduce(0,2); }
+#ifndef REDUCE_SKIP
+static inline void REDUCE_SKIP(dbm::fed_t& fed, size_t s) { dbm::partition_t::getReducer().reduce(fed, s); }
+#endif
 
 namespace dbm
 {
+    reducer_t& partition_t::getReducer()
+    {
+        static reducer_t reducer;
+        return reducer;
+    }
+
     void partition_t::intern()
     {
         assert(fedTable);
@@ -0,0 +1,133 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : pipeline.cpp
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "dbm/pipeline.h"
+
+namespace dbm
+{
+    pipeline_t& pipeline_t::up()
+    {
+        ops.push_back({UP, 0, 0, 0});
+        return *this;
+    }
+
+    pipeline_t& pipeline_t::down()
+    {
+        ops.push_back({DOWN, 0, 0, 0});
+        return *this;
+    }
+
+    pipeline_t& pipeline_t::freeClock(cindex_t clock)
+    {
+        assert(clock > 0 && clock < fed.getDimension());
+        ops.push_back({FREE_CLOCK, clock, 0, 0});
+        return *this;
+    }
+
+    pipeline_t& pipeline_t::updateValue(cindex_t x, int32_t v)
+    {
+        assert(x > 0 && x < fed.getDimension());
+        ops.push_back({UPDATE_VALUE, x, 0, v});
+        return *this;
+    }
+
+    pipeline_t& pipeline_t::constrain(cindex_t i, cindex_t j, raw_t c)
+    {
+        assert(i < fed.getDimension() && j < fed.getDimension());
+        ops.push_back({CONSTRAIN, i, j, c});
+        return *this;
+    }
+
+    pipeline_t& pipeline_t::extrapolateMaxBounds(const int32_t* max)
+    {
+        ops.push_back({EXTRAPOLATE_MAX, 0, 0, copyBounds(max)});
+        return *this;
+    }
+
+    pipeline_t& pipeline_t::extrapolateLUBounds(const int32_t* lower, const int32_t* upper)
+    {
+        int32_t offset = copyBounds(lower);
+        copyBounds(upper);  // right after lower
+        ops.push_back({EXTRAPOLATE_LU, 0, 0, offset});
+        return *this;
+    }
+
+    pipeline_t& pipeline_t::reduce()
+    {
+        reduction = REDUCE;
+        return *this;
+    }
+
+    pipeline_t& pipeline_t::mergeReduce()
+    {
+        reduction = MERGE_REDUCE;
+        return *this;
+    }
+
+    pipeline_t& pipeline_t::convexReduce()
+    {
+        reduction = CONVEX_REDUCE;
+        return *this;
+    }
+
+    fed_t& pipeline_t::apply()
+    {
+        if (!ops.empty() && !fed.isEmpty()) {
+            for (auto it = fed.begin_mutable(), end = fed.end_mutable(); it != end;) {
+                if (apply(*it)) {
+                    ++it;
+                } else {
+                    it.removeEmpty();
+                }
+            }
+        }
+        ops.clear();
+        bounds.clear();
+
+        switch (reduction) {
+        case NO_REDUCE: break;
+        case REDUCE: fed.reduce(); break;
+        case MERGE_REDUCE: fed.mergeReduce(); break;
+        case CONVEX_REDUCE: fed.convexReduce(); break;
+        }
+        reduction = NO_REDUCE;
+        return fed;
+    }
+
+    bool pipeline_t::apply(dbm_t& dbm) const
+    {
+        cindex_t dim = fed.getDimension();
+        for (const op_t& op : ops) {
+            switch (op.kind) {
+            case UP: dbm.up(); break;
+            case DOWN: dbm.down(); break;
+            case FREE_CLOCK: dbm.freeClock(op.i); break;
+            case UPDATE_VALUE: dbm.updateValue(op.i, op.value); break;
+            case CONSTRAIN:
+                if (!dbm.constrain(op.i, op.j, op.value)) {
+                    return false;
+                }
+                break;
+            case EXTRAPOLATE_MAX: dbm.extrapolateMaxBounds(&bounds[op.value]); break;
+            case EXTRAPOLATE_LU: dbm.extrapolateLUBounds(&bounds[op.value], &bounds[op.value + dim]); break;
+            }
+        }
+        return true;
+    }
+
+    int32_t pipeline_t::copyBounds(const int32_t* values)
+    {
+        assert(values);
+        auto offset = static_cast<int32_t>(bounds.size());
+        bounds.insert(bounds.end(), values, values + fed.getDimension());
+        return offset;
+    }
+}  // namespace dbm
@@ -0,0 +1,85 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : reduction.cpp
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "dbm/reduction.h"
+#include "dbm/budget.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace dbm
+{
+    fed_t& reducer_t::reduce(fed_t& fed, size_t skip)
+    {
+        if (fed.size() <= std::max<size_t>(skip, 1)) {
+            return fed;  // nothing new to reduce
+        }
+        budget_t limit(budget);
+        double spent = apply(first, fed, skip, limit);
+        for (int s = first + 1; s <= last && fed.size() >= escalationSize; ++s) {
+            if (limit.wasInterrupted() || (budget > 0 && spent >= budget)) {
+                break;
+            }
+            if (isWorth((strategy_t)s, fed)) {
+                spent += apply((strategy_t)s, fed, 0, limit);
+            }
+        }
+        return fed;
+    }
+
+    void reducer_t::setStrategies(strategy_t f, strategy_t l)
+    {
+        assert(f <= l && l < NB_STRATEGIES);
+        first = f;
+        last = l;
+    }
+
+    void reducer_t::resetStats() { std::fill(stats, stats + NB_STRATEGIES, stats_t{}); }
+
+    // An escalation is tried the first 8 times, then as long as it
+    // removes enough DBMs on average, and otherwise in 1/32 of the cases.
+    bool reducer_t::isWorth(strategy_t strategy, const fed_t& fed)
+    {
+        if (strategy >= EXPENSIVE_REDUCE && fed.size() * fed.getDimension() > maxWork) {
+            return false;
+        }
+        stats_t& s = stats[strategy];
+        if (s.calls < 8 || (double)s.after <= (1.0 - minShrink) * (double)s.before ||
+            (s.calls + s.skipped) % 32 == 0) {
+            return true;
+        }
+        s.skipped++;
+        return false;
+    }
+
+    double reducer_t::apply(strategy_t strategy, fed_t& fed, size_t skip, budget_t& limit)
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t before = fed.size();
+        switch (strategy) {
+        case REDUCE: fed.reduce(); break;
+        case MERGE_REDUCE: fed.mergeReduce(limit, skip); break;
+        case CONVEX_REDUCE: fed.convexReduce(); break;
+        case PARTITION_REDUCE: fed.partitionReduce(); break;
+        case EXPENSIVE_REDUCE: fed.expensiveReduce(limit); break;
+        case EXPENSIVE_CONVEX_REDUCE: fed.expensiveConvexReduce(limit); break;
+        case NB_STRATEGIES: assert(false); break;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        stats_t& s = stats[strategy];
+        s.calls++;
+        s.before += before;
+        s.after += fed.size();
+        s.seconds += seconds;
+        return seconds;
+    }
+}  // namespace dbm
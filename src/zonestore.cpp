@@ -0,0 +1,285 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : zonestore.cpp
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "dbm/zonestore.h"
+#include "dbm/dbm.h"
+
+#include <base/bitstring.h>
+#include <debug/macros.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace dbm
+{
+    // Zones in memory are allocated with new.
+    static int32_t* zonestore_new(size_t size, void*) { return new int32_t[size]; }
+
+    zonestore_t::zonestore_t(cindex_t d, std::string dir, size_t maxRes, size_t segSize, uint32_t dictThreshold):
+        dim(d),
+        directory(std::move(dir)),
+        maxResident(maxRes),
+        segmentSize(segSize),
+        buffer(d * d),
+        dict(dictThreshold > 0 ? dbm_newMinDBMDict(dictThreshold) : nullptr)
+    {
+        assert(dim > 0 && segmentSize > 0);
+    }
+
+    zonestore_t::~zonestore_t()
+    {
+        for (auto& entry : buckets) {
+            for (int32_t* zone : entry.second.zones) {
+                delete[] zone;
+            }
+        }
+        for (segment_t& segment : segments) {
+            unmap(segment);
+            std::remove(segment.path.c_str());
+        }
+        if (dict) {
+            dbm_deleteMinDBMDict(dict);
+        }
+    }
+
+    relation_t zonestore_t::relation(const raw_t* dbm, const int32_t* zone, raw_t* unpackBuffer) const
+    {
+        return dict ? dbm_relationWithDictMinDBM(dict, dbm, dim, zone, unpackBuffer)
+                    : dbm_relationWithMinDBM(dbm, dim, zone, unpackBuffer);
+    }
+
+    bool zonestore_t::mayContain(const bucket_t& bucket, const raw_t* dbm) const
+    {
+        const raw_t* bounds = bucket.bounds.data();
+        if (bucket.bounds.empty()) {
+            return false;
+        }
+        for (cindex_t i = 1; i < dim; ++i) {
+            if (dbm[i * dim] > bounds[i] || dbm[i] > bounds[dim + i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void zonestore_t::touch(uintptr_t key, bucket_t& bucket)
+    {
+        if (bucket.residentSize != 0) {
+            lru.splice(lru.end(), lru, bucket.lru);
+        } else {
+            bucket.lru = lru.insert(lru.end(), key);
+        }
+    }
+
+    bool zonestore_t::contains(uintptr_t key, const raw_t* dbm)
+    {
+        assert(dbm && dbm_isClosed(dbm, dim) && !dbm_isEmpty(dbm, dim));
+
+        stats.lookups++;
+        auto it = buckets.find(key);
+        if (it == buckets.end()) {
+            return false;
+        }
+        bucket_t& bucket = it->second;
+        if (!mayContain(bucket, dbm)) {
+            stats.summaryRejects++;
+            return false;
+        }
+        for (const int32_t* zone : bucket.zones) {
+            if (relation(dbm, zone, nullptr) & base_SUBSET) {
+                return true;
+            }
+        }
+        if (!bucket.spilled.empty()) {
+            stats.diskLookups++;
+            for (const extent_t& extent : bucket.spilled) {
+                const int32_t* zone = read(extent);
+                const int32_t* end = zone + extent.size;
+                for (; zone < end; zone += dbm_getSizeOfMinDBM(zone)) {
+                    if (relation(dbm, zone, nullptr) & base_SUBSET) {
+                        stats.diskHits++;
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    bool zonestore_t::add(uintptr_t key, const raw_t* dbm)
+    {
+        if (contains(key, dbm)) {
+            return false;
+        }
+
+        bucket_t& bucket = buckets[key];
+        if (bucket.residentSize != 0) {
+            // Remove the zones in memory included in dbm.
+            auto keep = [&](int32_t* zone) {
+                if (relation(dbm, zone, buffer.data()) == base_SUPERSET) {
+                    size_t size = dbm_getSizeOfMinDBM(zone);
+                    bucket.residentSize -= size;
+                    residentSize -= size;
+                    nbZones--;
+                    delete[] zone;
+                    return false;
+                }
+                return true;
+            };
+            auto end = std::stable_partition(bucket.zones.begin(), bucket.zones.end(), keep);
+            bucket.zones.erase(end, bucket.zones.end());
+            if (bucket.residentSize == 0) {
+                lru.erase(bucket.lru);
+            }
+        }
+
+        if (bucket.bounds.empty()) {
+            bucket.bounds.resize(2 * dim);
+            for (cindex_t i = 1; i < dim; ++i) {
+                bucket.bounds[i] = dbm[i * dim];
+                bucket.bounds[dim + i] = dbm[i];
+            }
+        } else {
+            for (cindex_t i = 1; i < dim; ++i) {
+                bucket.bounds[i] = std::max(bucket.bounds[i], dbm[i * dim]);
+                bucket.bounds[dim + i] = std::max(bucket.bounds[dim + i], dbm[i]);
+            }
+        }
+
+        allocator_t alloc = {nullptr, zonestore_new};
+        int32_t* zone = dict ? dbm_writeToDictMinDBMWithOffset(dict, dbm, dim, alloc, 0)
+                             : dbm_writeToMinDBMWithOffset(dbm, dim, true, true, alloc, 0);
+        size_t size = dbm_getSizeOfMinDBM(zone);
+        touch(key, bucket);
+        bucket.zones.push_back(zone);
+        bucket.residentSize += size;
+        residentSize += size;
+        nbZones++;
+        evict();
+        return true;
+    }
+
+    void zonestore_t::evict()
+    {
+        // Keep the most recent bucket in memory in any case.
+        while (residentSize > maxResident && lru.size() > 1) {
+            spill(buckets[lru.front()]);
+        }
+    }
+
+    void zonestore_t::spill()
+    {
+        while (!lru.empty()) {
+            spill(buckets[lru.front()]);
+        }
+    }
+
+    void zonestore_t::spill(bucket_t& bucket)
+    {
+        assert(bucket.residentSize != 0 && *bucket.lru == lru.front());
+
+        if (segments.empty() || segments.back().size >= segmentSize) {
+            std::string path = directory + "/zonestore-" + std::to_string(getpid()) + "-" +
+                               std::to_string(reinterpret_cast<uintptr_t>(this)) + "-" +
+                               std::to_string(segments.size()) + ".seg";
+            segments.push_back(segment_t{path, 0, nullptr, 0, {}});
+        }
+        segment_t& segment = segments.back();
+        FILE* file = std::fopen(segment.path.c_str(), "ab");
+        if (file == nullptr) {
+            throw std::runtime_error("Cannot open zone segment " + segment.path);
+        }
+        bool written = true;
+        for (int32_t* zone : bucket.zones) {
+            size_t size = dbm_getSizeOfMinDBM(zone);
+            written = written && std::fwrite(zone, sizeof(int32_t), size, file) == size;
+        }
+        written = (std::fclose(file) == 0) && written;
+        if (!written) {
+            throw std::runtime_error("Cannot write zone segment " + segment.path);
+        }
+
+        bucket.spilled.push_back(extent_t{(uint32_t)(segments.size() - 1), segment.size, bucket.residentSize});
+        segment.size += bucket.residentSize;
+        spilledSize += bucket.residentSize;
+        residentSize -= bucket.residentSize;
+        for (int32_t* zone : bucket.zones) {
+            delete[] zone;
+        }
+        bucket.zones.clear();
+        bucket.residentSize = 0;
+        lru.pop_front();
+        stats.spills++;
+    }
+
+    const int32_t* zonestore_t::read(const extent_t& extent)
+    {
+        segment_t& segment = segments[extent.segment];
+        if (extent.offset + extent.size > segment.mapped) {
+            map(segment);
+        }
+        assert(segment.data && extent.offset + extent.size <= segment.mapped);
+        return segment.data + extent.offset;
+    }
+
+    // The active segment grows, so it is remapped
+    // whenever a read goes past the mapped part.
+    void zonestore_t::map(segment_t& segment)
+    {
+        unmap(segment);
+#ifdef _WIN32
+        FILE* file = std::fopen(segment.path.c_str(), "rb");
+        segment.copy.resize(segment.size);
+        if (file == nullptr || std::fread(segment.copy.data(), sizeof(int32_t), segment.size, file) != segment.size) {
+            if (file) {
+                std::fclose(file);
+            }
+            throw std::runtime_error("Cannot read zone segment " + segment.path);
+        }
+        std::fclose(file);
+        segment.data = segment.copy.data();
+#else
+        int fd = open(segment.path.c_str(), O_RDONLY);
+        void* data = fd < 0 ? MAP_FAILED : mmap(nullptr, segment.size * sizeof(int32_t), PROT_READ, MAP_SHARED, fd, 0);
+        if (fd >= 0) {
+            close(fd);
+        }
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Cannot map zone segment " + segment.path);
+        }
+        segment.data = static_cast<const int32_t*>(data);
+#endif
+        segment.mapped = segment.size;
+    }
+
+    void zonestore_t::unmap(segment_t& segment)
+    {
+#ifdef _WIN32
+        segment.copy.clear();
+#else
+        if (segment.data) {
+            munmap(const_cast<int32_t*>(segment.data), segment.mapped * sizeof(int32_t));
+        }
+#endif
+        segment.data = nullptr;
+        segment.mapped = 0;
+    }
+}  // namespace dbm
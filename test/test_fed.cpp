@@ -15,6 +15,7 @@
 
 // Tests are always for debugging.
 
+#include "dbm/budget.h"
 #include "dbm/fed.h"
 #include "dbm/gen.h"
 #include "dbm/print.h"
@@ -399,6 +400,64 @@ static void test_copy(cindex_t dim, size_t size)
     }
 }
 
+// Test the bulk constructors
+static void test_bulk(cindex_t dim, size_t size)
+{
+    SHOW_TEST();
+    for (uint32_t k = 0; k < NB_LOOPS; ++k) {
+        PROGRESS();
+        auto fed = fed_t{test_gen(dim, size)};
+        std::vector<raw_t> block;
+        std::vector<dbm_t> dbms;
+        for (const auto& dbm : fed) {
+            block.insert(block.end(), dbm.const_dbm(), dbm.const_dbm() + dim * dim);
+            dbms.push_back(dbm);
+        }
+        size_t n = fed.size();
+
+        auto fed1 = fed_t{block.data(), n, dim};
+        CHECK(fed1.size() == n);
+        CHECK(fed1.getDimension() == dim);
+        auto it = fed.begin();
+        for (const auto& dbm : fed1) {  // same order
+            CHECK(dbm == *it);
+            ++it;
+        }
+        CHECK(fed1.eq(fed));
+
+        // Duplicates.
+        block.insert(block.end(), block.begin(), block.end());
+        auto fed2 = fed_t{block.data(), 2 * n, dim};
+        CHECK(fed2.size() == 2 * n);
+        auto fed3 = fed_t{block.data(), 2 * n, dim, true};
+        CHECK(fed3.size() <= n);
+        CHECK(fed3.eq(fed));
+        auto fed4 = fed_t{block.data(), 2 * n, dim, true, true};
+        CHECK(fed4.size() <= fed3.size());
+        CHECK(fed4.eq(fed));
+
+        // Shared DBMs, empty ones skipped.
+        dbms.push_back(dbm_t(dim));
+        dbms.insert(dbms.end(), dbms.begin(), dbms.end());
+        auto fed5 = fed_t{dbms.data(), dbms.size(), dim};
+        CHECK(fed5.size() == 2 * n);
+        if (n > 0) {
+            CHECK(fed5.begin()->sameAs(dbms[0]));
+        }
+        auto fed6 = fed_t{dbms.data(), dbms.size(), dim, true, true};
+        CHECK(fed6.eq(fed));
+        CHECK(fed6.size() <= n);
+
+        // Slabs freed only once all their DBMs are.
+        fed1.nil();
+        dbm::cleanUp();
+        CHECK(fed2.eq(fed));
+        fed2.nil();
+        dbm::cleanUp();
+        CHECK(fed_t{block.data(), n, dim}.eq(fed));
+    }
+}
+
 // Test |=
 static void test_union(cindex_t dim, size_t size)
 {
@@ -449,6 +508,135 @@ static void test_union(cindex_t dim, size_t size)
     }
 }
 
+// @return true if every DBM of fed1 is included in one DBM of fed2.
+static bool test_dbmsIncludedIn(const fed_t& fed1, const fed_t& fed2)
+{
+    for (const auto& dbm1 : fed1) {
+        if (std::none_of(fed2.begin(), fed2.end(), [&](const dbm_t& dbm2) { return dbm1 <= dbm2; })) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// @return true if two DBMs of fed are equal.
+static bool test_hasDuplicates(const fed_t& fed)
+{
+    for (auto i = fed.begin(); i != fed.end(); ++i) {
+        auto j = i;
+        for (++j; j != fed.end(); ++j) {
+            if (*i == *j) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Test |= and unionWith with federations large enough to
+// be indexed and with duplicated DBMs.
+static void test_largeUnion(cindex_t dim, size_t size)
+{
+    if (dim < 2) {
+        NO_TEST();
+        return;
+    }
+    SHOW_TEST();
+    for (uint32_t k = 0; k < NB_LOOPS / 4; ++k) {
+        PROGRESS();
+        // Reduced so that the union of fed1 and fed2 is reduced
+        // when the duplicates are dropped.
+        fed_t fed1 = test_gen(dim, 96 + size).reduce();
+        fed_t fed2 = test_gen(dim, 96).reduce();
+        std::vector<dbm_t> copies;
+        for (const auto& dbm : fed2) {
+            if (rand_int(4) == 0) {
+                copies.push_back(dbm);
+            }
+        }
+        for (const auto& dbm : copies) {
+            fed2.add(dbm);
+        }
+        fed_t all = fed1;
+        all.add(fed2);
+        fed_t reduced = fed_t(all).reduce();
+        fed_t fed3 = fed1, fed4 = fed2;
+
+        // duplicates inside the argument
+        fed3 |= fed2;
+        CHECK(fed3.size() == reduced.size());
+        CHECK(fed3.eq(reduced));
+        fed3 = fed1;
+        fed3.unionWith(fed4);
+        CHECK(fed3.eq(reduced));
+
+        // and with the federation
+        size_t n = rand_int(fed1.size());
+        for (auto i = fed1.begin(); n != 0; ++i, --n) {
+            fed2.add(*i);
+        }
+        all = fed1;
+        all.add(fed2);
+        fed3 = fed1;
+        fed4 = fed2;
+
+        fed1 |= fed2;
+        CHECK(test_dbmsIncludedIn(all, fed1));
+        CHECK(test_dbmsIncludedIn(fed1, all));
+        CHECK(fed1.size() <= all.size());
+        CHECK(!test_hasDuplicates(fed1));
+
+        fed3.unionWith(fed4);
+        CHECK(fed4.isEmpty());
+        CHECK(test_dbmsIncludedIn(all, fed3));
+        CHECK(test_dbmsIncludedIn(fed3, all));
+    }
+}
+
+// Test that |= reduces the argument below and above the size from
+// which the union is indexed.
+static void test_unionReducesArg(cindex_t dim, size_t size)
+{
+    if (dim < 2) {
+        NO_TEST();
+        return;
+    }
+    SHOW_TEST();
+    for (uint32_t k = 0; k < NB_LOOPS / 8; ++k) {
+        PROGRESS();
+        for (size_t n : {1 + size % 32, 96 + size}) {
+            fed_t fed1 = test_gen(dim, n).reduce();
+            fed_t arg = test_gen(dim, n).reduce();
+            // DBMs included in other DBMs of arg, not in fed1.
+            std::vector<dbm_t> included;
+            for (const auto& dbm : arg) {
+                if (rand_int(2) == 0) {
+                    // a copy or a tighter DBM, if not empty
+                    dbm_t sub = dbm;
+                    cindex_t i = rand_int(dim - 1) + 1;
+                    raw_t c = sub(i, 0);
+                    if (rand_int(2) == 0 && c != dbm_LS_INFINITY && sub.constrain(i, 0, c - 2)) {
+                        included.push_back(sub);
+                    } else {
+                        included.push_back(dbm);
+                    }
+                }
+            }
+            for (const auto& dbm : included) {
+                arg.add(dbm);
+            }
+            fed_t all = fed1;
+            all.add(arg);
+            fed_t reduced = fed_t(all).reduce();
+
+            fed1 |= arg;
+            CHECK(fed1.size() == reduced.size());
+            CHECK(fed1.eq(reduced));
+            CHECK(!test_hasDuplicates(fed1));
+        }
+    }
+}
+
 // Test +=
 static void test_convexUnion(cindex_t dim, size_t size)
 {
@@ -1349,6 +1537,51 @@ static void test_equal(cindex_t dim, size_t size)
     }
 }
 
+// test exact relations against subtractions
+static void test_exactRelation(cindex_t dim, size_t size)
+{
+    SHOW_TEST();
+    for (uint32_t k = 0; k < NB_LOOPS; ++k) {
+        PROGRESS();
+        fed_t fed1(test_gen(dim, size));
+        fed_t fed2 = fed1;
+        switch (rand_int(4)) {
+        case 0: test_addDBMs(fed2, size); break;  // superset
+        case 1:                                   // same set, other DBMs
+            if (!fed1.isEmpty()) {
+                fed2 -= test_getDBM(fed1);
+                fed2 |= test_getDBM(fed1);
+            }
+            break;
+        case 2:  // subset
+            if (!fed1.isEmpty()) {
+                fed2 -= test_getDBM(fed1);
+            }
+            break;
+        default: fed2 = test_gen(dim, size); break;
+        }
+        bool le = (fed1 - fed2).isEmpty();
+        bool ge = (fed2 - fed1).isEmpty();
+        relation_t rel = (relation_t)((le ? base_SUBSET : 0) | (ge ? base_SUPERSET : 0));
+        dbm_t dbm = fed1.isEmpty() ? dbm_t(dim) : test_getDBM(fed1);
+        bool dbmLe = dbm.isEmpty() || (fed_t(dbm) - fed2).isEmpty();
+
+        for (size_t threshold : {(size_t)0, (size_t)(1 + rand_int(8))}) {
+            fed_t::spatialIndex(threshold);
+            CHECK(fed1.exactRelation(fed2) == rel);
+            CHECK(fed2.exactRelation(fed1) == base_symRelation(rel));
+            CHECK(fed1.le(fed2) == le);
+            CHECK(fed1.ge(fed2) == ge);
+            CHECK(fed1.eq(fed2) == (le && ge));
+            CHECK(dbm.le(fed2) == dbmLe);
+            if (!dbm.isEmpty()) {
+                CHECK(fed_t::isSubtractionEmpty(dbm.const_dbm(), dim, fed2) == dbmLe);
+            }
+        }
+        fed_t::spatialIndex(0);
+    }
+}
+
 // test subtractions
 static void test_subtract(cindex_t dim, size_t size)
 {
@@ -1421,6 +1654,239 @@ static void test_subtract(cindex_t dim, size_t size)
     }
 }
 
+// @return true if the DBMs of fed1 and fed2 are the same, in the same order.
+static bool test_sameDBMs(const fed_t& fed1, const fed_t& fed2)
+{
+    if (fed1.size() != fed2.size())
+        return false;
+    auto i2 = fed2.begin();
+    for (const auto& dbm : fed1) {
+        if (dbm != *i2)
+            return false;
+        ++i2;
+    }
+    return true;
+}
+
+// test parallel subtraction against the sequential one
+static void test_parallelSubtract(cindex_t dim, size_t size)
+{
+    SHOW_TEST();
+    for (uint32_t k = 0; k < NB_LOOPS; ++k) {
+        PROGRESS();
+        fed_t fed1(test_gen(dim, 4 * size));
+        test_addDBMs(fed1, size);
+        fed_t fed2(test_genArg(size, fed1));
+        fed_t seq = fed1 - fed2;
+        fed_t seqDBM = fed1;
+        fed_t seqRaw = fed1;
+        dbm_t arg = fed2.isEmpty() ? dbm_t(dim) : test_getDBM(fed2);
+        if (!arg.isEmpty()) {
+            seqDBM -= arg;
+            seqRaw -= arg();
+        }
+
+        fed_t::parallelSubtraction(1 + rand_int(4), rand_int(3));
+        fed_t par = fed1 - fed2;
+        fed_t parDBM = fed1;
+        fed_t parRaw = fed1;
+        if (!arg.isEmpty()) {
+            parDBM -= arg;
+            parRaw -= arg();
+        }
+        fed_t::parallelSubtraction(1);
+
+        CHECK(test_sameDBMs(seq, par));
+        CHECK(test_sameDBMs(seqDBM, parDBM));
+        CHECK(test_sameDBMs(seqRaw, parRaw));
+
+        // The adaptive strategy learns the same in parallel.
+        fed_t::subtractionStrategy(fed_t::SUBTRACT_ADAPTIVE);
+        fed_t::resetSubtractionStats();
+        seq = fed1 - fed2;
+        fed_t::resetSubtractionStats();
+        fed_t::parallelSubtraction(1 + rand_int(4), rand_int(3));
+        par = fed1 - fed2;
+        fed_t::parallelSubtraction(1);
+        fed_t::subtractionStrategy(fed_t::SUBTRACT_WORST);
+        CHECK(test_sameDBMs(seq, par));
+    }
+}
+
+// The operations applied to every DBM in parallel give the same DBMs
+static void test_parallelOperations(cindex_t dim, size_t size)
+{
+    SHOW_TEST();
+    for (uint32_t k = 0; k < NB_LOOPS; ++k) {
+        PROGRESS();
+        constexpr int32_t range = 1000;
+        fed_t fed(test_gen(dim, 4 * size));
+        test_addDBMs(fed, size);
+        auto lower = std::vector<int32_t>(dim), upper = std::vector<int32_t>(dim);
+        for (cindex_t i = 1; i < dim; ++i) {
+            lower[i] = rand_int(range);
+            upper[i] = rand_int(range);
+        }
+        cindex_t x = rand_int(dim), y = rand_int(dim);
+        int32_t v = rand_int(range);
+        auto c = std::vector<constraint_t>{};
+        for (size_t n = 0; n < 3; ++n) {
+            cindex_t i = rand_int(dim), j = rand_int(dim);
+            if (i != j) {
+                c.push_back(constraint_t{i, j, dbm_boundbool2raw(rand_int(2 * range) - range, rand_int(2) == 0)});
+            }
+        }
+        auto operations = [&](fed_t& f) {
+            auto results = std::vector<fed_t>{};
+            results.push_back(f.up());
+            results.push_back(f.relaxUp());
+            if (x > 0) {
+                results.push_back(f.freeClock(x));
+                f.updateValue(x, v);
+                results.push_back(f);
+                results.push_back(f.relaxDownClock(x));
+            }
+            f.constrain(c.data(), c.size());
+            results.push_back(f);
+            f.extrapolateLUBounds(lower.data(), upper.data());
+            results.push_back(f);
+            f.diagonalExtrapolateMaxBounds(upper.data());
+            results.push_back(f);
+            results.push_back(f.down());
+            if (x > 0 && y > 0 && x != y) {
+                f.constrain(x, y, dbm_boundbool2raw(rand_int(range) - range / 2, false));
+                results.push_back(f);
+            }
+            return results;
+        };
+        fed_t seq = fed;
+        fed_t par = fed;
+        auto r = gen;  // same random values
+        auto seqResults = operations(seq);
+        fed_t::parallelOperations(2 + rand_int(3), rand_int(3));
+        gen = r;
+        auto parResults = operations(par);
+        // The DBMs that an operation does not change are kept as they are,
+        // even when they are shared.
+        auto pointers = [](const fed_t& f) {
+            auto dbms = std::vector<const raw_t*>{};
+            for (const auto& i : f) {
+                dbms.push_back(i.const_dbm());
+            }
+            std::sort(dbms.begin(), dbms.end());
+            return dbms;
+        };
+        par.up();
+        fed_t shared = par;
+        par.up();
+        CHECK(pointers(par) == pointers(shared));
+        par.constrain(c.data(), c.size());
+        shared = par;
+        par.constrain(c.data(), c.size());
+        CHECK(pointers(par) == pointers(shared));
+        fed_t::parallelOperations(1);
+
+        REQUIRE(seqResults.size() == parResults.size());
+        for (size_t n = 0; n < seqResults.size(); ++n) {
+            CHECK(test_sameDBMs(seqResults[n], parResults[n]));
+        }
+    }
+}
+
+// test the strategies and the non disjoint subtraction against the default one
+static void test_subtractionStrategy(cindex_t dim, size_t size)
+{
+    SHOW_TEST();
+    for (uint32_t k = 0; k < NB_LOOPS / 4; ++k) {
+        PROGRESS();
+        fed_t fed1(test_gen(dim, size));
+        test_addDBMs(fed1, size);
+        fed_t fed2(test_genArg(size, fed1));
+        fed_t expected = fed1 - fed2;
+
+        fed_t::resetSubtractionStats();
+        for (int s = fed_t::SUBTRACT_MINGRAPH; s <= fed_t::SUBTRACT_ADAPTIVE; ++s) {
+            fed_t::subtractionStrategy((fed_t::subtraction_t)s);
+            CHECK((fed1 - fed2).eq(expected));
+        }
+        fed_t::subtractionStrategy(fed_t::SUBTRACT_WORST);
+
+        // overlapping pieces, same set
+        fed_t overlapping(fed1);
+        CHECK(overlapping.subtract(fed2, false).eq(expected));
+        CHECK(fed1.le(fed2) == expected.isEmpty());
+
+        for (int s = fed_t::SUBTRACT_MINGRAPH; s < fed_t::SUBTRACT_ADAPTIVE; ++s) {
+            fed_t::subtraction_stats_t stats = fed_t::getSubtractionStats((fed_t::subtraction_t)s);
+            CHECK(stats.pieces <= stats.splits + stats.calls);
+        }
+    }
+}
+
+// Queries with the spatial index of fed and without.
+static void test_queries(const fed_t& fed, const fed_t& arg, const dbm_t& dbm, const std::vector<int32_t>& pt,
+                         const std::vector<double>& rpt)
+{
+    cindex_t dim = fed.getDimension();
+    fed_t::spatialIndex(0);
+    bool inter = fed.intersects(arg), interArg = arg.intersects(fed), interDBM = fed.intersects(dbm);
+    bool has = fed.has(dbm), super = fed.isSupersetEq(dbm(), dim);
+    bool in = fed.contains(pt), inReal = fed.contains(rpt);
+    relation_t rel = fed.relation(dbm);
+    fed_t inters = fed & arg, removed = fed;
+    removed.removeIncludedIn(arg);
+
+    fed_t::spatialIndex(1 + rand_int(8));
+    CHECK(fed.intersects(arg) == inter);
+    CHECK(arg.intersects(fed) == interArg);
+    CHECK(fed.intersects(dbm) == interDBM);
+    CHECK(fed.has(dbm) == has);
+    CHECK(fed.isSupersetEq(dbm(), dim) == super);
+    CHECK(fed.contains(pt) == in);
+    CHECK(fed.contains(rpt) == inReal);
+    CHECK(fed.relation(dbm) == rel);
+    CHECK(test_sameDBMs(fed & arg, inters));
+    fed_t removedIdx = fed;
+    removedIdx.removeIncludedIn(arg);
+    CHECK(test_sameDBMs(removedIdx, removed));
+    fed_t::spatialIndex(0);
+}
+
+// test spatial index
+static void test_spatialIndex(cindex_t dim, size_t size)
+{
+    SHOW_TEST();
+    std::vector<int32_t> pt(dim);
+    std::vector<double> rpt(dim);
+    for (uint32_t k = 0; k < NB_LOOPS; ++k) {
+        PROGRESS();
+        fed_t fed(test_gen(dim, 4 * size));
+        test_addDBMs(fed, size);
+        if (fed.isEmpty()) {
+            continue;
+        }
+        fed_t arg(test_genArg(size, fed));
+        dbm_t dbm = rand_int(2) != 0 || arg.isEmpty() ? test_getDBM(fed) : test_getDBM(arg);
+        if (!test_generatePoint(pt, rand_int(2) != 0 ? fed : fed_t(dbm))) {
+            std::fill(pt.begin(), pt.end(), 0);
+        }
+        if (!test_generateRealPoint(rpt, rand_int(2) != 0 ? fed : fed_t(dbm))) {
+            std::fill(rpt.begin(), rpt.end(), 0.0);
+        }
+        test_queries(fed, arg, dbm, pt, rpt);
+
+        // indexed, then modified
+        fed_t::spatialIndex(0);
+        fed.intersects(dbm);
+        fed.up();
+        fed.intersects(dbm);
+        if (dim > 1 && fed.constrain(1, 0, 500, dbm_WEAK)) {
+            test_queries(fed, arg, dbm, pt, rpt);
+        }
+        fed_t::spatialIndex(0);
+    }
+}
+
 // test predt
 static void test_predt(cindex_t dim, size_t size)
 {
@@ -1448,8 +1914,92 @@ static void test_predt(cindex_t dim, size_t size)
                 CHECK(p.eq(down(good)));
             if (!p.eq(down(good)))
                 CHECK(!bad.isEmpty());
+            CHECK(p.isIncludedInPredt(good, bad));
+
+            // remembered results
+            fed_t s(good);
+            bool ok = s.succt(bad);
+            fed_t::predtCache(4);
+            for (int n = 0; n < 2; ++n) {
+                CHECK(predt(good, bad).eq(p));
+                CHECK(p.isIncludedInPredt(good, bad));
+                fed_t sc(good);
+                CHECK(sc.succt(bad) == ok);
+                if (ok)
+                    CHECK(sc.eq(s));
+            }
+
+            // interned arguments and other arguments that evict them
+            fed_t other = up(good);
+            fed_t po = predt(other, bad);
+            fed_t::predtCache(1);
+            fed_t gi(good), bi(bad);
+            gi.intern();
+            bi.intern();
+            for (int n = 0; n < 2; ++n) {
+                CHECK(predt(gi, bi).eq(p));
+                CHECK(predt(other, bad).eq(po));
+            }
+            fed_t::predtCache(0);
+        }
+    }
+}
+
+// test the sharing of interned federations
+static void test_intern(cindex_t dim, size_t size)
+{
+    SHOW_TEST();
+    for (uint32_t k = 0; k < NB_LOOPS / 4; ++k) {
+        PROGRESS();
+        fed_t f1(test_gen(dim, size));
+        fed_t f2(dim);  // same DBMs in reverse order
+        for (const auto& dbm : f1) {
+            f2.add(dbm.const_dbm(), dim);
+        }
+        fed_t copy1(f1);
+        f1.intern();
+        f2.intern();
+        CHECK(f1.sameAs(f2));
+        CHECK(f1.hash() == f2.hash());
+        CHECK(f1.eq(copy1));
+
+        // modifications do not affect the other federations
+        f2.up();
+        CHECK(f2.eq(up(copy1)));
+        CHECK(f1.eq(copy1));
+        f1.intern();
+        fed_t f3(copy1);
+        f3.intern();
+        CHECK(f3.sameAs(f1));
+        f1.setEmpty();
+        f3.reduce();
+        CHECK(f3.eq(copy1));
+        fed_t f4(copy1);
+        f4.intern();
+        CHECK(f4.eq(copy1));
+        CHECK(f4.hash() == copy1.hash());
+    }
+}
+
+// @return true if no DBM of fed is included in another one,
+// or in the union of the others if expensive.
+static bool test_isReduced(const fed_t& fed, bool expensive)
+{
+    for (auto i = fed.begin(); i != fed.end(); ++i) {
+        fed_t others(fed.getDimension());
+        for (auto j = fed.begin(); j != fed.end(); ++j) {
+            if (i != j) {
+                if (*i <= *j) {
+                    return false;
+                }
+                others.add(*j);
+            }
+        }
+        if (expensive && i->le(others)) {
+            return false;
         }
     }
+    return true;
 }
 
 // test different reduce methods.
@@ -1483,6 +2033,63 @@ static void test_reduce(cindex_t dim, size_t size)
 
             (f2 = f1).setMutable();
             CHECK(f2.partitionReduce().eq(f1));
+
+            // anytime reductions, partial but valid
+            size_t steps = rand_int(2 * f1.size() * f1.size() + 1);
+            budget_t b1(0, steps), b2(0, steps), b3(0, steps);
+            (f2 = f1).setMutable();
+            CHECK(f2.expensiveReduce(b1).eq(f1));
+            CHECK(f2.size() <= f1.size());
+            CHECK((steps == 0 || b1.wasInterrupted() || b1.getWork() <= steps));
+            (f2 = f1).setMutable();
+            CHECK(f2.mergeReduce(b2, 0, rand_int(3)).eq(f1));
+            CHECK(f2.size() <= f1.size());
+            (f2 = f1).setMutable();
+            CHECK(f2.expensiveConvexReduce(b3).eq(f1));
+            CHECK(f2.size() <= f1.size());
+
+            // cancelled: nothing is done
+            budget_t cancelled;
+            cancelled.cancel();
+            (f2 = f1).setMutable();
+            CHECK(f2.mergeReduce(cancelled).size() == f1.size());
+            CHECK(f2.expensiveReduce(cancelled).size() == f1.size());
+            CHECK(f2.expensiveConvexReduce(cancelled).size() == f1.size());
+            CHECK((f1.size() <= 1 || cancelled.wasInterrupted()));
+
+            // out of budget in the subtractions of expensiveConvexReduce: unchanged
+            budget_t b4(0, f1.size());
+            (f2 = f1).setMutable();
+            CHECK(f2.expensiveConvexReduce(b4).size() == f1.size());
+            CHECK(f2.eq(f1));
+            CHECK((f1.size() <= 1 || b4.wasInterrupted()));
+
+            // incremental reductions of DBMs appended at the end
+            fed_t f4(test_genArg(size, f1));
+            fed_t all(f1);
+            all.add(f4);
+            fed_t f5 = f4;
+            (f2 = f1).setMutable();
+            CHECK(test_isReduced(f2.reduce().appendEnd(f5 = f4).reduce(), false));
+            CHECK(f2.eq(all));
+            (f2 = f1).setMutable();
+            CHECK(test_isReduced(f2.mergeReduce().appendEnd(f5 = f4).mergeReduce(), false));
+            CHECK(f2.eq(all));
+            (f2 = f1).setMutable();
+            CHECK(test_isReduced(f2.expensiveReduce().appendEnd(f5 = f4).expensiveReduce(), true));
+            CHECK(f2.eq(all));
+            (f2 = f1).setMutable();
+            CHECK(f2.convexReduce().appendEnd(f5 = f4).convexReduce().eq(all));
+
+            // unlimited: same as without budget
+            budget_t unlimited;
+            (f2 = f1).setMutable();
+            fed_t f3(dim);
+            for (const auto& dbm : f1) {
+                f3.add(dbm);
+            }
+            CHECK(test_sameDBMs(f2.expensiveReduce(unlimited), f3.expensiveReduce()));
+            CHECK(!unlimited.wasInterrupted());
         }
     }
 }
@@ -1492,7 +2099,10 @@ static void test(int dim, int size)
     test_setZero(dim);
     test_setInit(dim);
     test_copy(dim, size);
+    test_bulk(dim, size);
     test_union(dim, size);
+    test_largeUnion(dim, size);
+    test_unionReducesArg(dim, size);
     test_convexUnion(dim, size);
     test_intersection(dim, size);
     test_constrain(dim, size);
@@ -1513,8 +2123,14 @@ static void test(int dim, int size)
     test_freeAllDown(dim, size);
     test_relaxUp(dim, size);
     test_equal(dim, size);
+    test_exactRelation(dim, size);
     test_subtract(dim, size);
+    test_parallelSubtract(dim, size);
+    test_parallelOperations(dim, size);
+    test_spatialIndex(dim, size);
+    test_subtractionStrategy(dim, size);
     test_predt(dim, size);
+    test_intern(dim, size);
     test_reduce(dim, size);
 }
 
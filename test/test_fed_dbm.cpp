@@ -546,6 +546,87 @@ static void test(const cindex_t dim)
     PROGRESS();
 }
 
+// The cached upper bounds follow the changes of the DBMs and
+// the quick reject never rejects DBMs that intersect.
+static void test_bounds(const cindex_t dim)
+{
+    auto dbm = NEW(dim);
+    auto dbm2 = NEW(dim);
+    for (int k = 0; k < 23; ++k) {
+        GEN(dbm);
+        GEN(dbm2);
+        auto a = dbm_t{dbm, dim};
+        auto b = dbm_t{dbm2, dim};
+        if (k & 1)
+            b.intern();
+        CHECK(a.hasDisjointBounds(b) == b.hasDisjointBounds(a));
+        CHECK(a.hasDisjointBounds(b) == a.hasDisjointBounds(dbm2, dim));
+        if (a.hasDisjointBounds(b))
+            CHECK(!dbm_haveIntersection(dbm, dbm2, dim));
+        auto c = b;  // shared with b
+        c.up();
+        c.relaxDown();
+        for (cindex_t i = 0; i < dim; ++i) {
+            CHECK(a.getUpperBounds()[i] == dbm[i * dim]);
+            CHECK(b.getUpperBounds()[i] == dbm2[i * dim]);
+            CHECK(c.getUpperBounds()[i] == c(i, 0));
+        }
+    }
+    FREE(dbm2);
+    FREE(dbm);
+}
+
+// No-op up, freeClock, updateValue and constrain keep the matrix,
+// shared or not, its hash and its stored minimal graph.
+static void test_noop(const cindex_t dim)
+{
+    auto dbm = NEW(dim);
+    for (int k = 0; k < 23; ++k) {
+        GEN(dbm);
+        auto a = dbm_t{dbm, dim};
+        const cindex_t c = 1 + k % (dim - 1);
+        const int32_t v = k;
+        switch (k % 4) {  // make the operation a no-op
+        case 0: a.up(); break;
+        case 1: a.freeClock(c); break;
+        case 2: a.updateValue(c, v); break;
+        default: break;  // constrain with the constraints of the DBM
+        }
+        auto cnstr = std::vector<constraint_t>{};
+        for (cindex_t i = 0; i < dim; ++i) {
+            for (cindex_t j = 0; j < dim; ++j) {
+                if (i != j && a(i, j) != dbm_LS_INFINITY)
+                    cnstr.push_back(constraint_t{i, j, a(i, j)});
+            }
+        }
+        for (int shared = 0; shared < 2; ++shared) {
+            auto b = a;  // shares the matrix with a
+            if (!shared)
+                b.nil();
+            const raw_t* matrix = a();
+            const uint32_t hash = a.hash();
+#ifdef ENABLE_STORE_MINGRAPH
+            size_t size;
+            const uint32_t* ming = a.getMinDBM(&size);
+#endif
+            switch (k % 4) {
+            case 0: a.up(); break;
+            case 1: a.freeClock(c); break;
+            case 2: a.updateValue(c, v); break;
+            default: CHECK(a.constrain(cnstr)); break;
+            }
+            CHECK(a() == matrix);  // no copy
+            CHECK(a.hash() == hash);
+#ifdef ENABLE_STORE_MINGRAPH
+            CHECK(a.getMinDBM(&size) == ming);
+#endif
+            if (shared)
+                CHECK(b() == matrix);
+        }
+    }
+    FREE(dbm);
+}
+
 TEST_CASE("Test DBM federation")
 {
     cindex_t start;
@@ -563,5 +644,8 @@ TEST_CASE("Test DBM federation")
         for (int k = 0; k < 300; ++k) {
             test(i);
         }
+        test_bounds(i);
+        if (i > 1)
+            test_noop(i);
     }
 }
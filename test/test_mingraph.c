@@ -30,6 +30,10 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <time.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 /* number of loops per size tested
  */
@@ -104,7 +108,8 @@ static raw_t* allocDBM(uint32_t dim) { return (raw_t*)malloc(dim * dim * sizeof(
 static void test_printStats(int32_t* stats, uint32_t* sizes, uint32_t dim)
 {
     static const char* statNames[] = {"Trivial    ", "Copy32     ", "BitMatrix32", "Couplesij32",
-                                      "Copy16     ", "BitMatrix16", "Couplesij16", "ERROR      "};
+                                      "Copy16     ", "BitMatrix16", "Couplesij16", "Delta32    ",
+                                      "Delta16    ", "Dict       ", "ERROR      "};
 
     uint32_t i, totalFull = 0, totalReduced = 0;
     for (i = 0; i < dbm_MINDBM_ERROR; ++i) {
@@ -130,6 +135,7 @@ static void test(size_t dim, bool tryBest)
     size_t testSize = bits2intsize(dim * dim), nbCons1, nbCons2;
     uint32_t* testMG1 = (uint32_t*)calloc(testSize, sizeof(uint32_t));
     uint32_t* testMG2 = (uint32_t*)calloc(testSize, sizeof(uint32_t));
+    mingraph_dict_t* dict = dbm_newMinDBMDict(2);
 
     printf("** Testing size=%zu **\n", dim);
 
@@ -201,6 +207,62 @@ static void test(size_t dim, bool tryBest)
         assert(dbm_relationWithMinDBM(dbm1, dim, ming, NULL) == base_SUBSET);
         assert(dbm_relationWithMinDBM(dbm1, dim, ming, dbm2) == base_EQUAL);
 
+        /* canonical hash, independent of the encoding */
+        debug_randomize(dbm2, dim * dim);
+        assert(dbm_hashOfAnalyzedDBM(dbm1, dim, testMG1) == dbm_hashOfMinDBM(ming, dbm2));
+        ming2 = dbm_writeToMinDBMWithOffset(dbm1, dim, !minGraph, !try16, c_alloc, 0);
+        assert(dbm_hashOfMinDBM(ming2, dbm2) == dbm_hashOfMinDBM(ming, dbm2));
+        test_free(ming2);
+
+        /* dictionary, learning from all the tested DBMs */
+        ming2 = dbm_writeToDictMinDBMWithOffset(dict, dbm1, dim, c_alloc, offset);
+        assert(dim == dbm_getDimOfMinDBM(ming2 + offset));
+        assert(allocSize == offset + dbm_getSizeOfMinDBM(ming2 + offset));
+        type = dbm_getRepresentationType(ming2 + offset);
+        sizes[type] += allocSize - offset;
+        stats[type]++;
+        {
+            /* never bigger than the usual encoding, which is used otherwise */
+            int32_t* ming3 = dbm_writeToMinDBMWithOffset(dbm1, dim, true, true, c_alloc, 0);
+            assert(dbm_getSizeOfMinDBM(ming2 + offset) <= allocSize);
+            assert(dbm_isDictMinDBM(ming2 + offset) || base_areEqual(ming2 + offset, ming3, allocSize));
+            test_free(ming3);
+        }
+        debug_randomize(dbm2, dim * dim);
+        assert(dim == dbm_readFromDictMinDBM(dict, dbm2, ming2 + offset));
+        DBM_EQUAL(dbm1, dbm2);
+        assert(dbm_relationWithDictMinDBM(dict, dbm1, dim, ming2 + offset, NULL) == base_SUBSET);
+        assert(dbm_relationWithDictMinDBM(dict, dbm1, dim, ming2 + offset, dbm2) == base_EQUAL);
+        test_free(ming2);
+
+        /* delta against a successor-like base (k even) or a random base */
+        if (k & 1) {
+            dbm_generate(dbm3, dim, range);
+        } else {
+            dbm_copy(dbm3, dbm1, dim);
+            dbm_up(dbm3, dim);
+        }
+        ming2 = dbm_writeToDeltaMinDBMWithOffset(dbm1, dbm3, dim, try16, c_alloc, offset);
+        assert(dbm_isDeltaMinDBM(ming2 + offset));
+        assert(!dbm_isDeltaMinDBM(ming));
+        assert(dim == dbm_getDimOfMinDBM(ming2 + offset));
+        assert(allocSize == offset + dbm_getSizeOfMinDBM(ming2 + offset));
+        assert(allocSize == offset + dbm_getSizeOfDeltaMinDBMFor(dbm1, dbm3, dim, try16));
+        debug_randomize(dbm2, dim * dim);
+        assert(dim == dbm_readFromDeltaMinDBM(dbm2, dbm3, ming2 + offset));
+        DBM_EQUAL(dbm1, dbm2);
+        assert(dbm_relationWithDeltaMinDBM(dbm1, dim, dbm3, ming2 + offset) == base_EQUAL);
+        assert(dbm_relationWithDeltaMinDBM(dbm3, dim, dbm3, ming2 + offset) == dbm_relation(dbm3, dbm1, dim));
+        test_free(ming2);
+
+        ming2 = dbm_writeToMinDBMRelativeTo(dbm1, dim, dbm3, minGraph, try16, c_alloc, offset);
+        assert(allocSize == offset + dbm_getSizeOfMinDBM(ming2 + offset));
+        debug_randomize(dbm2, dim * dim);
+        assert(dim == dbm_readFromMinDBMRelativeTo(dbm2, dbm3, ming2 + offset));
+        DBM_EQUAL(dbm1, dbm2);
+        assert(dbm_relationWithMinDBMRelativeTo(dbm1, dim, dbm3, ming2 + offset, dbm2) == base_EQUAL);
+        test_free(ming2);
+
         dbm_generateSuperset(dbm2, dbm1, dim);
         if (!dbm_areEqual(dbm1, dbm2, dim)) /* then superset strict */
         {
@@ -271,6 +333,8 @@ static void test(size_t dim, bool tryBest)
     }
 
     test_printStats(stats, sizes, dim);
+    printf("Dictionary: %zu constraints\n", dbm_getNbEntriesOfMinDBMDict(dict));
+    dbm_deleteMinDBMDict(dict);
 
     free(stats);
     free(sizes);
@@ -281,6 +345,276 @@ static void test(size_t dim, bool tryBest)
     free(testMG2);
 }
 
+/* Batch encoding against the encoding of every DBM
+ */
+static void test_batch(size_t dim, bool tryBest)
+{
+    const size_t nb = 16;
+    size_t dim2 = dim * dim, bitSize = bits2intsize(dim2), total, k;
+    raw_t* dbms = (raw_t*)malloc(nb * dim2 * sizeof(raw_t));
+    raw_t* dbms2 = (raw_t*)malloc(nb * dim2 * sizeof(raw_t));
+    uint32_t* bitMatrices = (uint32_t*)malloc(nb * bitSize * sizeof(uint32_t));
+    size_t* offsets = (size_t*)malloc((nb + 1) * sizeof(size_t));
+    uint32_t flags, allocSize;
+    allocator_t c_alloc = {.allocData = &allocSize, .allocFunction = test_alloc};
+
+    for (k = 0; k < nb; ++k) {
+        dbm_generate(dbms + k * dim2, dim, (k & 1) ? 0xfff : 0xfffffff);
+    }
+
+    for (flags = 0; flags < 4; ++flags) {
+        bool minGraph = tryBest || (flags & 1) != 0;
+        bool try16 = tryBest || (flags & 2) != 0;
+        int32_t* arena;
+
+        debug_randomize((int32_t*)bitMatrices, nb * bitSize);
+        total = dbm_getSizeOfMinDBMsFor(dbms, nb, dim, minGraph, try16, bitMatrices, offsets);
+        assert(total == offsets[nb] && offsets[0] == 0);
+        arena = (int32_t*)malloc(total * sizeof(int32_t));
+        dbm_writeToMinDBMs(dbms, nb, dim, minGraph, try16, bitMatrices, offsets, arena);
+
+        for (k = 0; k < nb; ++k) {
+            int32_t* ming = dbm_writeToMinDBMWithOffset(dbms + k * dim2, dim, minGraph, try16, c_alloc, 0);
+            assert(allocSize == offsets[k + 1] - offsets[k]);
+            assert(allocSize == dbm_getSizeOfMinDBM(arena + offsets[k]));
+            assert(base_areEqual(ming, arena + offsets[k], allocSize));
+            test_free(ming);
+        }
+
+        debug_randomize(dbms2, nb * dim2);
+        dbm_readFromMinDBMs(dbms2, dim, arena, offsets, nb);
+        for (k = 0; k < nb; ++k) {
+            ASSERT(dbm_areEqual(dbms + k * dim2, dbms2 + k * dim2, dim),
+                   DIFF(dbms + k * dim2, dbms2 + k * dim2));
+        }
+        free(arena);
+    }
+
+    free(offsets);
+    free(bitMatrices);
+    free(dbms2);
+    free(dbms);
+}
+
+/* The block decoders, portable and native, against the reference
+ * decoder, on dense random DBMs and on sparse DBMs that are encoded
+ * with couples (i,j), with indices on 4, 8 or 16 bits depending on dim.
+ */
+static void test_decoders(size_t dim)
+{
+    const decoderOfMinDBM_t decoders[] = {dbm_DECODE_PORTABLE, dbm_DECODE_NATIVE};
+    decoderOfMinDBM_t current = dbm_getMinDBMDecoder();
+    size_t dim2 = dim * dim, offsets[2] = {0, 0};
+    raw_t* dbm1 = allocDBM(dim);
+    raw_t* dbm2 = allocDBM(dim);
+    raw_t* dbm3 = allocDBM(dim);
+    uint32_t allocSize, k, d;
+    allocator_t c_alloc = {.allocData = &allocSize, .allocFunction = test_alloc};
+
+    for (k = 0; k < (dim <= 16 ? LOOPS / 4 : LOOPS / dim); ++k) {
+        int32_t* ming;
+
+        if ((k & 4 || dim > 16) && dim > 1) { /* a few constraints, 0 stays in the DBM */
+            uint32_t n = 1 + rand() % dim;
+            dbm_init(dbm1, dim);
+            while (n--) {
+                cindex_t i = rand() % dim, j = rand() % dim;
+                if (i != j) {
+                    dbm_constrain1(dbm1, dim, i, j, dbm_bound2raw(rand() % ((k & 8) ? 100 : 100000), dbm_WEAK));
+                }
+            }
+        } else {
+            dbm_generate(dbm1, dim, (k & 8) ? 0xfff : 0xfffffff);
+        }
+        ming = dbm_writeToMinDBMWithOffset(dbm1, dim, (k & 1) != 0, (k & 2) != 0, c_alloc, 0);
+
+        assert(dbm_setMinDBMDecoder(dbm_DECODE_REFERENCE));
+        debug_randomize(dbm2, dim2);
+        assert(dbm_readFromMinDBM(dbm2, ming) == dim);
+        DBM_EQUAL(dbm1, dbm2);
+
+        for (d = 0; d < sizeof(decoders) / sizeof(decoders[0]); ++d) {
+            if (dbm_setMinDBMDecoder(decoders[d])) {
+                assert(dbm_getMinDBMDecoder() == decoders[d]);
+                debug_randomize(dbm3, dim2);
+                assert(dbm_readFromMinDBM(dbm3, ming) == dim);
+                DBM_EQUAL(dbm2, dbm3);
+                debug_randomize(dbm3, dim2);
+                dbm_readFromMinDBMs(dbm3, dim, ming, offsets, 1);
+                DBM_EQUAL(dbm2, dbm3);
+            }
+        }
+        test_free(ming);
+    }
+
+    dbm_setMinDBMDecoder(current);
+    free(dbm3);
+    free(dbm2);
+    free(dbm1);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+/* Run one of the generic functions on a delta or a dictionary
+ * mingraph in a child process.
+ * @return true if the child exits with the fatal error status 2.
+ */
+static bool test_rejects(int what, const raw_t* dbm, cindex_t dim, mingraph_t ming, raw_t* buffer)
+{
+    int status;
+    pid_t pid;
+
+    fflush(stdout);
+    fflush(stderr);
+    pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        if (!freopen("/dev/null", "w", stderr)) {
+            _exit(1);
+        }
+        switch (what) {
+        case 0: dbm_readFromMinDBM(buffer, ming); break;
+        case 1: dbm_hashOfMinDBM(ming, buffer); break;
+        case 2: dbm_relationWithMinDBM(dbm, dim, ming, buffer); break;
+        case 3: dbm_isEqualToMinDBM(dbm, dim, ming); break;
+        case 4: dbm_isUnpackedEqualToMinDBM(dbm, dim, ming, buffer); break;
+        default: dbm_convexUnionWithMinDBM(buffer, dim, ming, allocDBM(dim)); break;
+        }
+        _exit(0);
+    }
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 2;
+}
+#endif
+
+/* A dictionary mingraph is not readable without its dictionary:
+ * the generic functions must reject it and not decode it as a copy.
+ */
+static void test_dictRejected(size_t dim)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    raw_t* dbm = allocDBM(dim);
+    raw_t* buffer = allocDBM(dim);
+    uint32_t allocSize, k;
+    allocator_t c_alloc = {.allocData = &allocSize, .allocFunction = test_alloc};
+    mingraph_dict_t* dict = dbm_newMinDBMDict(1); /* learn at first sight */
+
+    for (k = 0; k < 16; ++k) {
+        int32_t* ming;
+
+        dbm_generate(dbm, dim, 0xfffffff);
+        test_free(dbm_writeToDictMinDBMWithOffset(dict, dbm, dim, c_alloc, 0)); /* learn */
+        ming = dbm_writeToDictMinDBMWithOffset(dict, dbm, dim, c_alloc, 0);
+        if (dbm_isDictMinDBM(ming)) {
+            int what;
+            for (what = 0; what < 6; ++what) {
+                assert(test_rejects(what, dbm, dim, ming, buffer));
+            }
+            assert(dbm_readFromDictMinDBM(dict, buffer, ming) == dim);
+            DBM_EQUAL(dbm, buffer);
+            test_free(ming);
+            break;
+        }
+        test_free(ming);
+    }
+    assert(dim < 4 || k < 16); /* references beat the usual encoding */
+
+    dbm_deleteMinDBMDict(dict);
+    free(buffer);
+    free(dbm);
+#endif
+}
+
+/* A delta mingraph is not readable without its base DBM:
+ * the generic functions must reject it and not decode it as a copy.
+ */
+static void test_deltaRejected(size_t dim)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    raw_t *dbm, *base, *buffer;
+    uint32_t allocSize;
+    allocator_t c_alloc = {.allocData = &allocSize, .allocFunction = test_alloc};
+    int try16;
+
+    if (dim < 2) { /* the trivial DBM has nothing to decode */
+        return;
+    }
+    dbm = allocDBM(dim);
+    base = allocDBM(dim);
+    buffer = allocDBM(dim);
+    for (try16 = 0; try16 < 2; ++try16) {
+        int32_t* ming;
+        int what;
+
+        dbm_generate(dbm, dim, try16 ? 0xfff : 0xfffffff);
+        dbm_copy(base, dbm, dim);
+        dbm_up(base, dim);
+        ming = dbm_writeToDeltaMinDBMWithOffset(dbm, base, dim, try16, c_alloc, 0);
+        assert(dbm_isDeltaMinDBM(ming));
+        for (what = 0; what < 6; ++what) {
+            assert(test_rejects(what, dbm, dim, ming, buffer));
+        }
+        test_free(ming);
+    }
+
+    free(buffer);
+    free(base);
+    free(dbm);
+#endif
+}
+
+/* Encoding policies: every mingraph reads back as the DBM, the
+ * size objective is the default encoding, and the statistics
+ * count what was written.
+ */
+static void test_policy(size_t dim, bool tryBest)
+{
+    const size_t nb = 16;
+    size_t dim2 = dim * dim, k, n;
+    raw_t* dbm = allocDBM(dim);
+    raw_t* dbm2 = allocDBM(dim);
+    uint32_t allocSize;
+    allocator_t c_alloc = {.allocData = &allocSize, .allocFunction = test_alloc};
+    objectiveOfMinDBM_t objective;
+
+    for (objective = dbm_MINDBM_FOR_SIZE; objective <= dbm_MINDBM_FOR_BLEND; ++objective) {
+        mingraph_policy_t* policy = dbm_newMinDBMPolicy(objective, 0.5);
+        const statsOfMinDBMPolicy_t* stats;
+
+        assert(dbm_getStatsOfMinDBMPolicy(policy, dim) == NULL);
+        for (k = 0; k < nb; ++k) {
+            int32_t* ming;
+
+            dbm_generate(dbm, dim, (k & 1) ? 0xfff : 0xfffffff);
+            ming = dbm_writeToMinDBMWithPolicy(policy, dbm, dim, tryBest, c_alloc, 0);
+            assert(allocSize == dbm_getSizeOfMinDBM(ming));
+            if (objective == dbm_MINDBM_FOR_SIZE) {
+                int32_t* ming2 = dbm_writeToMinDBMWithOffset(dbm, dim, true, tryBest, c_alloc, 0);
+                assert(allocSize == dbm_getSizeOfMinDBM(ming) && base_areEqual(ming, ming2, allocSize));
+                test_free(ming2);
+            }
+            debug_randomize(dbm2, dim2);
+            dbm_readFromMinDBM(dbm2, ming);
+            ASSERT(dbm_areEqual(dbm, dbm2, dim), DIFF(dbm, dbm2));
+            assert(dbm_relationWithMinDBM(dbm, dim, ming, dbm2) == base_EQUAL);
+            test_free(ming);
+        }
+
+        stats = dbm_getStatsOfMinDBMPolicy(policy, dim);
+        if (dim > 2) {
+            assert(stats);
+            n = stats->nbWritten[0] + stats->nbWritten[1] + stats->nbWritten[2];
+            assert(n <= nb);
+            assert(objective == dbm_MINDBM_FOR_SIZE || stats->nbMeasured > 0);
+        } else {
+            assert(stats == NULL);
+        }
+        dbm_deleteMinDBMPolicy(policy);
+    }
+
+    free(dbm2);
+    free(dbm);
+}
+
 int main(int argc, char* argv[])
 {
     int i, start, end, seed;
@@ -307,8 +641,16 @@ int main(int argc, char* argv[])
      */
     printf("Testing with seed=%d\n", seed);
 
-    for (i = start; i <= end; ++i)
+    for (i = start; i <= end; ++i) {
         test(i, tryBest);
+        test_batch(i, tryBest);
+        test_policy(i, tryBest);
+        test_decoders(i);
+        test_dictRejected(i);
+        test_deltaRejected(i);
+    }
+    test_decoders(end + 16);  /* indices (i,j) on 8 bits */
+    test_decoders(end + 256); /* on 16 bits */
 
     printf("\nPassed\n");
     return 0;
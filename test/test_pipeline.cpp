@@ -0,0 +1,159 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : test_pipeline.cpp
+//
+// Test pipeline_t (pipeline.h) against the operations of fed_t.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "dbm/pipeline.h"
+#include "dbm/gen.h"
+
+#include <doctest/doctest.h>
+
+#include <random>
+#include <vector>
+
+using namespace dbm;
+
+// Range for DBM generation
+constexpr auto MAXRANGE = 1000;
+
+static auto gen = std::mt19937{};
+
+static size_t rand_int(size_t mx) { return mx < 2 ? 0 : std::uniform_int_distribution<size_t>{0, mx - 1}(gen); }
+
+// Same DBMs in the same order.
+static bool sameDBMs(const fed_t& fed1, const fed_t& fed2)
+{
+    if (fed1.size() != fed2.size()) {
+        return false;
+    }
+    auto i = fed2.begin();
+    for (const auto& dbm : fed1) {
+        if (dbm != *i) {
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+// Copy without sharing, which would change the order of the DBMs
+// of the first federation to be modified.
+static fed_t copyOf(const fed_t& fed)
+{
+    fed_t result(fed.getDimension());
+    for (const auto& dbm : fed) {
+        fed_t last(dbm);
+        result.appendEnd(last);
+    }
+    return result;
+}
+
+static void genBounds(std::vector<int32_t>& bounds)
+{
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        bounds[i] = i == 0 ? 0 : rand_int(MAXRANGE) - 1;
+    }
+}
+
+static void test(cindex_t dim, size_t size)
+{
+    std::vector<raw_t> dbm(dim * dim);
+    std::vector<int32_t> lower(dim), upper(dim);
+    fed_t fed(dim);
+    for (size_t k = 0; k < size; ++k) {
+        dbm_generate(dbm.data(), dim, MAXRANGE);
+        fed.add(dbm.data(), dim);
+    }
+
+    for (int loop = 0; loop < 10; ++loop) {
+        fed_t expected = copyOf(fed);
+        pipeline_t ops(fed);
+        for (size_t n = rand_int(8); n != 0; --n) {
+            cindex_t i = rand_int(dim), j = rand_int(dim);
+            switch (rand_int(6)) {
+            case 0:
+                expected.up();
+                ops.up();
+                break;
+            case 1:
+                expected.down();
+                ops.down();
+                break;
+            case 2:
+                if (i != 0) {
+                    expected.freeClock(i);
+                    ops.freeClock(i);
+                }
+                break;
+            case 3:
+                if (i != 0) {
+                    int32_t v = rand_int(MAXRANGE);
+                    expected.updateValue(i, v);
+                    ops.updateValue(i, v);
+                }
+                break;
+            case 4:
+                if (i != j) {
+                    raw_t c = dbm_boundbool2raw(rand_int(2 * MAXRANGE) - MAXRANGE, rand_int(2) == 0);
+                    expected.constrain(i, j, c);
+                    ops.constrain(i, j, c);
+                }
+                break;
+            case 5:
+                genBounds(lower);
+                genBounds(upper);
+                if (rand_int(2) == 0) {
+                    expected.extrapolateMaxBounds(lower.data());
+                    ops.extrapolateMaxBounds(lower.data());
+                } else {
+                    expected.extrapolateLUBounds(lower.data(), upper.data());
+                    ops.extrapolateLUBounds(lower.data(), upper.data());
+                }
+                genBounds(lower);  // the pipeline has its own copy
+                genBounds(upper);
+                break;
+            }
+        }
+        switch (rand_int(3)) {
+        case 0: break;
+        case 1:
+            expected.reduce();
+            ops.reduce();
+            break;
+        case 2:
+            expected.mergeReduce();
+            ops.mergeReduce();
+            break;
+        }
+        ops.apply();
+        CHECK(ops.size() == 0);
+        CHECK(sameDBMs(fed, expected));
+    }
+
+    // Applied at the end of the statement.
+    if (dim > 1) {
+        fed_t expected = copyOf(fed);
+        expected.up();
+        expected.constrain(dim - 1, 0, dbm_boundbool2raw(MAXRANGE / 2, false));
+        expected.reduce();
+        pipeline_t(fed).up().constrain(dim - 1, 0, MAXRANGE / 2, false).reduce();
+        CHECK(sameDBMs(fed, expected));
+    }
+}
+
+TEST_CASE("Federation pipelines")
+{
+    for (cindex_t dim = 1; dim <= 8; ++dim) {
+        for (size_t size = 0; size <= 40; size += 5) {
+            test(dim, size);
+        }
+    }
+}
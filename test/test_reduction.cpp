@@ -0,0 +1,147 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : test_reduction.cpp
+//
+// Test reducer_t (reduction.h) and its use by partition_t.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "dbm/reduction.h"
+#include "dbm/partition.h"
+#include "dbm/gen.h"
+
+#include <doctest/doctest.h>
+
+#include <random>
+#include <vector>
+
+using namespace dbm;
+
+// Range for DBM generation
+constexpr auto MAXRANGE = 1000;
+
+static auto gen = std::mt19937{};
+
+static size_t rand_int(size_t mx) { return mx < 2 ? 0 : std::uniform_int_distribution<size_t>{0, mx - 1}(gen); }
+
+// Random DBMs, some of them included in others, so that
+// there is something to reduce.
+static fed_t generate(cindex_t dim, size_t size)
+{
+    std::vector<raw_t> dbm(dim * dim);
+    fed_t fed(dim);
+    for (size_t k = 0; k < size; ++k) {
+        if (k > 0 && dim > 1 && rand_int(2) == 0) {
+            dbm_t sub = *fed.begin();
+            cindex_t i = rand_int(dim), j = rand_int(dim);
+            if (i != j) {
+                sub.constrain(i, j, dbm_boundbool2raw(rand_int(2 * MAXRANGE) - MAXRANGE, false));
+            }
+            fed.add(sub);
+        } else {
+            dbm_generate(dbm.data(), dim, MAXRANGE);
+            fed.add(dbm.data(), dim);
+        }
+    }
+    return fed;
+}
+
+static void test(reducer_t& reducer, cindex_t dim, size_t size)
+{
+    fed_t fed = generate(dim, size);
+    fed_t expected(dim);
+    for (const auto& dbm : fed) {
+        expected.add(dbm);  // unshared copy, reductions affect all copies
+    }
+    size_t skip = rand_int(fed.size());
+    reducer.reduce(fed, skip);
+    CHECK(fed.eq(expected));
+    CHECK(fed.size() <= size);
+}
+
+TEST_CASE("Reduction policy")
+{
+    reducer_t reducer;
+
+    // mergeReduce only by default.
+    for (cindex_t dim = 1; dim <= 6; ++dim) {
+        test(reducer, dim, 30);
+    }
+    CHECK(reducer.getStats(reducer_t::MERGE_REDUCE).calls > 0);
+    for (int s = 0; s < reducer_t::NB_STRATEGIES; ++s) {
+        CHECK((s == reducer_t::MERGE_REDUCE || reducer.getStats((reducer_t::strategy_t)s).calls == 0));
+    }
+
+    // With escalations.
+    reducer.resetStats();
+    reducer.setStrategies(reducer_t::MERGE_REDUCE, reducer_t::EXPENSIVE_CONVEX_REDUCE);
+    for (cindex_t dim = 1; dim <= 6; ++dim) {
+        for (size_t size = 0; size <= 40; size += 4) {
+            test(reducer, dim, size);
+        }
+    }
+    size_t calls = 0;
+    for (int s = 0; s < reducer_t::NB_STRATEGIES; ++s) {
+        const auto& stats = reducer.getStats((reducer_t::strategy_t)s);
+        CHECK(stats.after <= stats.before);
+        calls += stats.calls;
+    }
+    CHECK(reducer.getStats(reducer_t::REDUCE).calls == 0);
+    CHECK(reducer.getStats(reducer_t::MERGE_REDUCE).calls > 0);
+    CHECK(reducer.getStats(reducer_t::CONVEX_REDUCE).calls > 0);
+    CHECK(calls > reducer.getStats(reducer_t::MERGE_REDUCE).calls);
+
+    reducer.resetStats();
+    CHECK(reducer.getStats(reducer_t::MERGE_REDUCE).calls == 0);
+
+    // No escalation.
+    reducer.setStrategies(reducer_t::REDUCE, reducer_t::REDUCE);
+    for (cindex_t dim = 1; dim <= 6; ++dim) {
+        test(reducer, dim, 30);
+    }
+    CHECK(reducer.getStats(reducer_t::REDUCE).calls > 0);
+    CHECK(reducer.getStats(reducer_t::MERGE_REDUCE).calls == 0);
+
+    // Only the expensive ones, limited.
+    reducer.resetStats();
+    reducer.setStrategies(reducer_t::MERGE_REDUCE, reducer_t::EXPENSIVE_CONVEX_REDUCE);
+    reducer.setEscalationSize(2);
+    reducer.setMaxWork(0);
+    for (cindex_t dim = 2; dim <= 6; ++dim) {
+        test(reducer, dim, 30);
+    }
+    CHECK(reducer.getStats(reducer_t::PARTITION_REDUCE).calls > 0);
+    CHECK(reducer.getStats(reducer_t::EXPENSIVE_REDUCE).calls == 0);
+    CHECK(reducer.getStats(reducer_t::EXPENSIVE_CONVEX_REDUCE).calls == 0);
+
+    // A spent budget stops the escalation.
+    reducer.resetStats();
+    reducer.setBudget(1e-12);
+    for (cindex_t dim = 2; dim <= 6; ++dim) {
+        test(reducer, dim, 30);
+    }
+    CHECK(reducer.getStats(reducer_t::MERGE_REDUCE).calls > 0);
+    CHECK(reducer.getStats(reducer_t::CONVEX_REDUCE).calls == 0);
+}
+
+TEST_CASE("Partition reduction")
+{
+    for (cindex_t dim = 2; dim <= 5; ++dim) {
+        partition_t part(dim);
+        fed_t all(dim);
+        for (uintptr_t id = 0; id < 8; ++id) {
+            fed_t fed = generate(dim, 10);
+            all |= fed;
+            part.add(id, fed);
+            CHECK(fed.isEmpty());
+        }
+        CHECK(part.getAll().eq(all));
+    }
+    CHECK(partition_t::getReducer().getStats(reducer_t::MERGE_REDUCE).calls > 0);
+    CHECK(partition_t::getReducer().getStats(reducer_t::CONVEX_REDUCE).calls == 0);
+}
@@ -0,0 +1,122 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : test_zonestore.cpp
+//
+// Test zonestore_t (zonestore.h)
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "dbm/dbm.h"
+#include "dbm/gen.h"
+#include "dbm/zonestore.h"
+
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <vector>
+
+using namespace dbm;
+
+// Range for DBM generation
+constexpr auto MAXRANGE = 1000;
+
+// Reference: dbm is included in one of the zones added to a bucket.
+static bool included(const std::vector<std::vector<raw_t>>& zones, const raw_t* dbm, cindex_t dim)
+{
+    for (const auto& zone : zones) {
+        if (dbm_isSubsetEq(dbm, zone.data(), dim)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void test(cindex_t dim, size_t maxResident, uint32_t dictThreshold = 0)
+{
+    constexpr auto NB_KEYS = 7;
+    const auto dir = std::filesystem::temp_directory_path().string();
+    auto store = zonestore_t(dim, dir, maxResident, 256, dictThreshold);
+    auto added = std::vector<std::vector<std::vector<raw_t>>>(NB_KEYS);
+    auto dbm = std::vector<raw_t>(dim * dim);
+
+    for (uint32_t n = 0; n < 300; ++n) {
+        uintptr_t key = rand() % NB_KEYS;
+        auto& zones = added[key];
+        if (!zones.empty() && rand() % 2 == 0) {
+            // likely to be included
+            if (!dbm_generateSubset(dbm.data(), zones[rand() % zones.size()].data(), dim))
+                continue;
+        } else if (!dbm_generate(dbm.data(), dim, MAXRANGE)) {
+            continue;
+        }
+        bool in = included(zones, dbm.data(), dim);
+        CHECK(store.contains(key, dbm.data()) == in);
+        CHECK(store.add(key, dbm.data()) == !in);
+        CHECK(store.contains(key, dbm.data()));
+        zones.push_back(dbm);
+        if (maxResident > 0) {
+            CHECK(store.getResidentSize() <= maxResident + dim * dim * NB_KEYS);
+        }
+    }
+    store.spill();
+    CHECK(store.getResidentSize() == 0);
+    for (uintptr_t key = 0; key < NB_KEYS; ++key) {
+        for (const auto& zone : added[key]) {
+            CHECK(store.contains(key, zone.data()));
+        }
+    }
+    if (store.getNumberOfZones() > 0) {
+        CHECK(store.getNumberOfSegments() > 0);
+        CHECK(store.getStats().diskHits > 0);
+    }
+}
+
+TEST_CASE("Zone store")
+{
+    for (cindex_t dim = 1; dim <= 6; ++dim) {
+        test(dim, 0);
+        test(dim, 200);
+        test(dim, 1 << 20);
+    }
+}
+
+TEST_CASE("Zone store with a dictionary")
+{
+    for (cindex_t dim = 1; dim <= 6; ++dim) {
+        test(dim, 0, 1);
+        test(dim, 200, 2);
+    }
+
+    // Boxes that differ on one clock share most of their constraints.
+    constexpr cindex_t dim = 10;
+    const auto dir = std::filesystem::temp_directory_path().string();
+    auto plain = zonestore_t(dim, dir, 1 << 20);
+    auto store = zonestore_t(dim, dir, 1 << 20, 256, 2);
+    auto boxes = std::vector<std::vector<raw_t>>();
+    for (int32_t k = 0; k < 100; ++k) {
+        auto& dbm = boxes.emplace_back(dim * dim);
+        dbm_init(dbm.data(), dim);
+        for (cindex_t i = 1; i < dim; ++i) {
+            int32_t low = i == 1 ? 2 * k : 10 * i;
+            dbm_constrain1(dbm.data(), dim, 0, i, dbm_bound2raw(-low, dbm_WEAK));
+            dbm_constrain1(dbm.data(), dim, i, 0, dbm_bound2raw(low + 3, dbm_WEAK));
+        }
+        CHECK(plain.add(0, dbm.data()));
+        CHECK(store.add(0, dbm.data()));
+    }
+    REQUIRE(store.getDictionary() != nullptr);
+    CHECK(plain.getDictionary() == nullptr);
+    CHECK(dbm_getNbEntriesOfMinDBMDict(store.getDictionary()) > 0);
+    CHECK(store.getNumberOfZones() == plain.getNumberOfZones());
+    CHECK(store.getResidentSize() < plain.getResidentSize());
+    store.spill();
+    for (const auto& dbm : boxes) {
+        CHECK(store.contains(0, dbm.data()));
+    }
+    CHECK(store.getStats().diskHits > 0);
+}